@@ -137,6 +137,25 @@ namespace CGRAOmp {
 
 			virtual llvm::json::Value getConfigAsJson(Instruction *I) const;
 
+			/**
+			 * @brief Get the AG configuration of a memory access
+			 * 
+			 * @param I memory access instruction
+			 * @return const ConfigTy* the configuration, or nullptr if it is not analyzed
+			 */
+			const ConfigTy* getConfig(Instruction *I) const {
+				auto it = config.find(I);
+				return (it != config.end()) ? &(it->second) : nullptr;
+			}
+
+			/**
+			 * @brief convert an AG configuration to JSON
+			 * 
+			 * @param C the configuration
+			 * @return llvm::json::Value JSON object containing base and offset
+			 */
+			static llvm::json::Value configToJson(const ConfigTy &C);
+
 		private:
 			DenseMap<Instruction*, ConfigTy> config;
 			SmallVector<Instruction*> invalid_list;
@@ -0,0 +1,150 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /include/BankAssignmentAnalysis.hpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 04:32:52
+*    Last Modified: 17-10-2026 04:32:52
+*/
+#ifndef BankAssignmentAnalysis_H
+#define BankAssignmentAnalysis_H
+
+#include "llvm/IR/PassManager.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/LoopAnalysisManager.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/Support/JSON.h"
+
+#include "AGVerifyPass.hpp"
+
+using namespace llvm;
+
+namespace CGRAOmp {
+
+	/**
+	 * @class BankAssignment
+	 * @brief BankAssignmentAnalysis result
+	 */
+	class BankAssignment {
+		public:
+			/**
+			 * @brief a slot of memory bank for a stream
+			 */
+			typedef struct {
+				int bank;
+				int port;
+			} SlotTy;
+
+			/**
+			 * @brief assign a memory access to a slot
+			 * 
+			 * @param I memory access instruction
+			 * @param slot the assigned slot
+			 */
+			void assign(Instruction *I, SlotTy slot) {
+				slots[I] = slot;
+			}
+
+			/**
+			 * @brief Get the slot of a memory access
+			 * 
+			 * @param I memory access instruction
+			 * @return const SlotTy* the slot, or nullptr if it is not assigned
+			 */
+			const SlotTy* getSlot(Instruction *I) const {
+				auto it = slots.find(I);
+				return (it != slots.end()) ? &(it->second) : nullptr;
+			}
+
+			/**
+			 * @brief Get the slot of a memory access as JSON
+			 * 
+			 * @param I memory access instruction
+			 * @return Optional<json::Value> JSON object containing bank and port if assigned
+			 */
+			Optional<json::Value> getSlotAsJson(Instruction *I) const;
+
+			/// set the number of streams sharing a port with others
+			void setNumConflicts(int num) {
+				conflicts = num;
+			}
+
+			/// get the number of streams sharing a port with others
+			int getNumConflicts() const {
+				return conflicts;
+			}
+
+			/**
+			 * @brief record the bank where an array is allocated
+			 * 
+			 * @param base base pointer of the array
+			 * @param bank the assigned bank
+			 */
+			void setArrayBank(Value *base, int bank) {
+				array_banks[base] = bank;
+			}
+
+			/// get the banks of the arrays accessed by the kernel
+			const MapVector<Value*, int>& getArrayBanks() const {
+				return array_banks;
+			}
+
+		private:
+			DenseMap<Instruction*, SlotTy> slots;
+			MapVector<Value*, int> array_banks;
+			int conflicts = 0;
+	};
+
+	/**
+	 * @class BankAssignmentAnalysisPass
+	 * @brief A loop pass to assign arrays accessed by AG streams to memory banks
+	 * @details
+	 * All the streams for an array are placed in the same bank, in which the array is allocated.
+	 * Loads with the same base and the same configuration for all dimensions are regarded as a single stream because the data can be broadcasted.
+	 * Arrays are assigned in descending order of the number of streams to the least loaded bank so that the streams sharing a port are minimized.
+	 * It is applied only if the CGRA model has the memory bank setting.
+	 * The placement is decided for each kernel, so DFGPassHandler warns if an array is placed in different banks by kernels in the same module.
+	 */
+	class BankAssignmentAnalysisPass :
+			public AnalysisInfoMixin<BankAssignmentAnalysisPass> {
+		public:
+			using Result = BankAssignment;
+			Result run(Loop &L, LoopAnalysisManager &AM,
+								LoopStandardAnalysisResults &AR);
+		private:
+			friend AnalysisInfoMixin<BankAssignmentAnalysisPass>;
+			static AnalysisKey Key;
+
+			using ConfigTy = AffineAGCompatibility::ConfigTy;
+
+			/**
+			 * @brief check if two configurations generate the same address stream
+			 */
+			bool isSameStream(const ConfigTy &A, const ConfigTy &B);
+	};
+}
+
+#endif //BankAssignmentAnalysis_H
@@ -37,6 +37,7 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/IR/Constant.h"
 #include "llvm/IR/Instruction.h"
+#include "llvm/IR/InstrTypes.h"
 #include "llvm/ADT/APFloat.h"
 #include "llvm/Support/JSON.h"
 
@@ -44,6 +45,7 @@
 #include "OptionPlugin.hpp"
 #include "Utils.hpp"
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <stdint.h>
@@ -76,6 +78,11 @@ namespace llvm {
 				Compare,
 				Constant,
 				GlobalData,
+				Counter,
+				Delay,
+				ShiftRegister,
+				WideMemAccess,
+				SubWord,
 				VirtualRoot,
 			};
 
@@ -92,6 +99,8 @@ namespace llvm {
 				*this = std::move(N);
 			}
 
+			virtual ~DFGNode() = default;
+
 			DFGNode &operator=(const DFGNode &N) {
 				DGNode::operator=(N);
 				return *this;
@@ -126,6 +135,17 @@ namespace llvm {
 				return !extra_info.empty();
 			}
 
+			/**
+			 * @brief copy all the extra info from another node
+			 * 
+			 * @param N source node
+			 */
+			void copyExtraInfo(const DFGNode &N) {
+				for (auto &item : N.extra_info) {
+					setExtraInfo(item.getKey(), *(item.getValue()));
+				}
+			}
+
 			json::Value getExtraInfoAsJSONObject() {
 				if (!hasExtraInfo()) {
 					return json::Object({});
@@ -173,11 +193,19 @@ namespace llvm {
 			ComputeNode(Instruction* inst, std::string opcode) : 
 				DFGNode(DFGNode::NodeKind::Compute, inst), opcode(opcode) {}
 
+			/// constructor with an explicit node ID
+			ComputeNode(Instruction* inst, std::string opcode, int ID) : 
+				DFGNode(ID, DFGNode::NodeKind::Compute, inst), opcode(opcode) {}
+
 			string getUniqueName() const {
 				return opcode + "_" + to_string(getID());
 			}
 			string getNodeAttr() const {
-				return formatv("type=op,{0}={1}", OptDFGOpKey, opcode);
+				string attr = formatv("type=op,{0}={1}", OptDFGOpKey, opcode);
+				if (pe_class != "") {
+					attr += formatv(",pe_class=\"{0}\"", pe_class);
+				}
+				return attr;
 			}
 			static bool classof(const DFGNode* N) {
 				return N->getKind() == NodeKind::Compute;
@@ -185,8 +213,201 @@ namespace llvm {
 			Instruction* getInst() const {
 				return dyn_cast<Instruction>(val);
 			}
+			/// get the operation name in the DFG
+			StringRef getOpcode() const {
+				return opcode;
+			}
+			/**
+			 * @brief Set the PE classes able to execute the operation
+			 * 
+			 * @param classes class names separated by '|'
+			 */
+			void setPEClass(StringRef classes) {
+				pe_class = classes.str();
+			}
 		private:
 			std::string opcode;
+			std::string pe_class;
+	};
+
+	/**
+	 * @class CounterNode
+	 * @brief A concrete class for hardware loop counter nodes
+	 * @details It replaces the arithmetic of an induction variable and
+	 * its exit condition. Constant start and bound values are embedded
+	 * as node attributes. Otherwise, they are given via in-coming edges
+	 * (operand 0: start, operand 1: bound).
+	 * The counter continues while <em>(value + step) cmp bound</em> holds,
+	 * where @em cmp is exported as the "cmp" attribute (e.g., slt, sle, ne).
+	*/
+	class CounterNode : public DFGNode {
+		public:
+			CounterNode(PHINode *indvar, Value *start, int64_t step,
+						Value *bound, CmpInst::Predicate pred, int nest_level) :
+				DFGNode(DFGNode::NodeKind::Counter, indvar), start(start),
+				bound(bound), step(step), pred(pred), nest_level(nest_level) {}
+
+			string getUniqueName() const {
+				return "Counter_" + to_string(getID());
+			}
+			string getNodeAttr() const;
+
+			Value* getStart() const { return start; }
+			Value* getBound() const { return bound; }
+			CmpInst::Predicate getBoundPredicate() const { return pred; }
+			int64_t getStep() const { return step; }
+			int getNestLevel() const { return nest_level; }
+
+			static bool classof(const DFGNode* N) {
+				return N->getKind() == NodeKind::Counter;
+			}
+		private:
+			Value *start, *bound;
+			int64_t step;
+			CmpInst::Predicate pred;
+			int nest_level;
+	};
+
+	/**
+	 * @class DelayNode
+	 * @brief A concrete class for delay registers
+	 * @details A chain of the nodes carries a value over more than one iteration
+	 * instead of a round-trip through memory.
+	*/
+	class DelayNode : public DFGNode {
+		public:
+			DelayNode(Value *def, int ID, int stage) :
+				DFGNode(ID, DFGNode::NodeKind::Delay, def), stage(stage) {}
+
+			string getUniqueName() const {
+				return "Delay_" + to_string(getID());
+			}
+			string getNodeAttr() const {
+				return formatv("type=op,{0}=delay,stage={1}", OptDFGOpKey, stage);
+			}
+			/// get the position in the delay chain (1: the closest to the def node)
+			int getStage() const { return stage; }
+
+			static bool classof(const DFGNode* N) {
+				return N->getKind() == NodeKind::Delay;
+			}
+		private:
+			int stage;
+	};
+
+	/**
+	 * @class ShiftRegisterNode
+	 * @brief A concrete class for a tap of line buffers
+	 * @details It outputs the input data delayed by @em depth iterations.
+	*/
+	class ShiftRegisterNode : public DFGNode {
+		public:
+			ShiftRegisterNode(Value *src, int depth) :
+				DFGNode(0, DFGNode::NodeKind::ShiftRegister, src), depth(depth) {
+				// src is shared with the replaced node
+				ID = (std::uintptr_t)(this);
+			}
+
+			string getUniqueName() const {
+				return "ShiftReg_" + to_string(getID());
+			}
+			string getNodeAttr() const {
+				return formatv("type=op,{0}=shiftreg,depth={1}", OptDFGOpKey, depth);
+			}
+			/// get the number of iterations to be delayed
+			int getDepth() const { return depth; }
+
+			static bool classof(const DFGNode* N) {
+				return N->getKind() == NodeKind::ShiftRegister;
+			}
+		private:
+			int depth;
+	};
+
+	/**
+	 * @class WideMemAccessNode
+	 * @brief A concrete class for a memory access merging adjacent scalar accesses
+	 * @details The lanes are placed in order of the address from the leader access.
+	 * For decoupled CGRAs, it is an I/O node of a stream like MemAccessNode.
+	 * Otherwise, it is an operation node of a load/store unit.
+	*/
+	class WideMemAccessNode : public DFGNode {
+		public:
+			/**
+			 * @brief Construct a new WideMemAccessNode
+			 * 
+			 * @param leader the access to the lowest address
+			 * @param lanes the number of merged accesses
+			 * @param lane_width bit width of each lane
+			 * @param symbol the accessed symbol for an I/O node.
+			 * If it is empty, the node is regarded as an operation node.
+			 */
+			WideMemAccessNode(Instruction *leader, int lanes, int lane_width,
+								std::string symbol = "") :
+				DFGNode(0, DFGNode::NodeKind::WideMemAccess, leader),
+				lanes(lanes), lane_width(lane_width), symbol(symbol) {
+				// leader is shared with the replaced node
+				ID = (std::uintptr_t)(this);
+			}
+
+			bool isLoad() const { return isa<LoadInst>(val); }
+
+			string getUniqueName() const {
+				return (isLoad() ? "WideLoad_" : "WideStore_") + to_string(getID());
+			}
+			string getNodeAttr() const {
+				if (symbol.empty()) {
+					return formatv("type=op,{0}={1},lanes={2},width={3}",
+									OptDFGOpKey, isLoad() ? "wload" : "wstore",
+									lanes, lane_width);
+				} else {
+					return formatv("type={0},data={1},lanes={2},width={3}",
+									isLoad() ? "input" : "output", symbol,
+									lanes, lane_width);
+				}
+			}
+			int getLanes() const { return lanes; }
+			int getLaneWidth() const { return lane_width; }
+
+			static bool classof(const DFGNode* N) {
+				return N->getKind() == NodeKind::WideMemAccess;
+			}
+		private:
+			int lanes, lane_width;
+			std::string symbol;
+	};
+
+	/**
+	 * @class SubWordNode
+	 * @brief A concrete class for extracting/inserting a lane of a wide data
+	 * @details An extract node takes the wide data via operand 0.
+	 * An insert node takes the lane data via operand 0 and the partially packed data via operand 1 (absent for the first lane).
+	*/
+	class SubWordNode : public DFGNode {
+		public:
+			SubWordNode(Value *v, bool is_extract, int lane) :
+				DFGNode(0, DFGNode::NodeKind::SubWord, v),
+				is_extract(is_extract), lane(lane) {
+				// v is shared with the replaced node
+				ID = (std::uintptr_t)(this);
+			}
+
+			string getUniqueName() const {
+				return (is_extract ? "Extract_" : "Insert_") + to_string(getID());
+			}
+			string getNodeAttr() const {
+				return formatv("type=op,{0}={1},lane={2}", OptDFGOpKey,
+								is_extract ? "extract" : "insert", lane);
+			}
+			bool isExtract() const { return is_extract; }
+			int getLane() const { return lane; }
+
+			static bool classof(const DFGNode* N) {
+				return N->getKind() == NodeKind::SubWord;
+			}
+		private:
+			bool is_extract;
+			int lane;
 	};
 
 	class MemAccessNode : public DFGNode {
@@ -224,6 +445,15 @@ namespace llvm {
 			 * If a symbol is not found, it return "unknown"
 			 */
 			string getSymbol() const {
+				return getSymbolOf(addr);
+			}
+
+			/**
+			 * @brief Get a symbol name accessed with an address
+			 * @param addr address operand of a memory access
+			 * @return string the symbol, or "unknown" if it is not found
+			 */
+			static string getSymbolOf(Value *addr) {
 				if (auto gep = dyn_cast<GetElementPtrInst>(addr)) {
 					auto *ptr = gep->getPointerOperand();
 					if (isa<Argument>(*ptr)) {
@@ -381,25 +611,10 @@ namespace llvm {
 
 
 	template<char const* OPCODE_STR>
-	class GEPNode : public DFGNode {
+	class GEPNode : public ComputeNode {
 		public:
 			GEPNode(GetElementPtrInst *gep, int ID) : 
-				DFGNode(ID, DFGNode::NodeKind::Compute, gep), opcode(OPCODE_STR) {}
-
-			string getUniqueName() const {
-				return opcode + "_" + to_string(getID());
-			}
-			string getNodeAttr() const {
-				return formatv("type=op,{0}={1}", OptDFGOpKey, opcode);
-			}
-			static bool classof(const DFGNode* N) {
-				return N->getKind() == NodeKind::Compute;
-			}
-			Instruction* getInst() const {
-				return dyn_cast<Instruction>(val);
-			}
-		private:
-			std::string opcode;
+				ComputeNode(gep, OPCODE_STR, ID) {}
 	};
 
 	class GEPConstantNode : public ConstantNode {
@@ -440,6 +655,8 @@ namespace llvm {
 				*this = std::move(E);
 			};
 
+			virtual ~DFGEdge() = default;
+
 			DFGEdge &operator=(const DFGEdge &E) {
 				DFGEdgeBase::operator=(E);
 				return *this;
@@ -455,6 +672,9 @@ namespace llvm {
 			}
 
 			EdgeKind getKind() const { return Kind; }
+
+			/// get the operand index of the target node
+			int getOperand() const { return operand; }
 			
 		protected:
 			int operand;
@@ -521,7 +741,8 @@ namespace llvm {
 			};
 			CGRADFG(const CGRADFG &G) = delete;
 			/// move constructor
-			CGRADFG(CGRADFG &&G) : CGRADFGBase(std::move(G)) {
+			CGRADFG(CGRADFG &&G) : CGRADFGBase(std::move(G)),
+				removed_nodes(std::move(G.removed_nodes)) {
 				virtual_root = G.virtual_root;
 				G.virtual_root = nullptr;
 			};
@@ -599,8 +820,66 @@ namespace llvm {
 				return !EL.empty();
 			}
 
+			/**
+			 * @brief find the source node of a data operand
+			 * 
+			 * @param N Node
+			 * @param operand operand index of N
+			 * @return NodeType* the source node connected with a normal edge, or nullptr if not found
+			 */
+			NodeType* findOperandNode(const NodeType &N, int operand) const;
+
+			/**
+			 * @brief move all the out-going edges of a node to another node
+			 * 
+			 * @param From node to be replaced
+			 * @param To node to be used instead
+			 */
+			void replaceAllUsesWith(NodeType &From, NodeType &To);
+
+			/**
+			 * @brief remove a node and its source nodes which become dead
+			 * @details Source nodes are removed recursively if they do not have any out-going edges after the removal.
+			 * The recursion stops at loop counters, constants, and global data.
+			 * 
+			 * @param N node to be removed
+			 */
+			void removeNodeAndDeadOperands(NodeType &N);
+
+			/**
+			 * @brief move all the nodes of another graph into this graph
+			 * @details Constant and global data nodes already existing in this graph are shared instead of being duplicated.
+			 * After the merge, @em G has only its virtual root.
+			 * 
+			 * @param G graph to be merged
+			 */
+			void mergeGraph(CGRADFG &G);
+
+			/**
+			 * @brief Get the number of nodes except for the virtual root
+			 */
+			unsigned getNumNodes() const {
+				return size() - 1;
+			}
+
+			/**
+			 * @brief Get the number of edges except for those from the virtual root
+			 */
+			unsigned getNumEdges() const;
+
+			/**
+			 * @brief Set extra information about the whole graph
+			 * @details It is saved as "__GRAPH" entry in the extra info file.
+			 * 
+			 * @param key key of the information
+			 * @param V value of the information
+			 */
+			void setGraphExtraInfo(StringRef key, json::Value V) {
+				graph_info[key] = std::move(V);
+			}
+
 			bool hasExtraInfo() const {
-				bool find = false;
+				bool find = !graph_info.empty();
 				for (auto *Node : Nodes) {
 					if (Node->hasExtraInfo()) {
 						find = true;
@@ -663,8 +942,11 @@ namespace llvm {
 				CGRADFGBase::addNode(*virtual_root);
 			}
 			NodeType *virtual_root = nullptr;
+			/// nodes removed from the graph, freed with the graph
+			SmallVector<std::unique_ptr<NodeType>> removed_nodes;
 
 			string name = "";
+			json::Object graph_info;
 
 			Function *F;
 			Loop *L;
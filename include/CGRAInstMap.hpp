@@ -31,12 +31,16 @@
 #ifndef CGRAInstMap_H
 #define CGRAInstMap_H
 
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/IR/Constant.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Instruction.h"
+#include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/Operator.h"
 #include "llvm/Support/JSON.h"
 #include "llvm/IR/PassManager.h"
@@ -51,13 +55,7 @@
 #define CGRAOMP_CUSTOM_INST_ATTR "cgra_custom_inst"
 
 
-#define FLAG_GETTER(FLAG, ISA, GETTER) make_pair(FLAG, [](Instruction *I) { \
-	if (isa<ISA>(I)) { \
-		return I->GETTER(); \
-	} else { \
-		return false;\
-	} \
-})
+#define FLAG_BIT_PAIR(FLAG, BIT) make_pair(FLAG, MapCondition::BIT)
 
 #define CMP_PRED_PAIR(STR, ENUM) make_pair(STR, CmpInst::Predicate::ENUM)
 
@@ -69,6 +67,13 @@
 		return make_shared<BinaryOpMapEntry>(OPCODE, BinaryOperator::OPENUM); \
 	}\
 })
+#define UNARYOP_ENTRY(OPCODE, OPENUM) make_pair(OPCODE, [](MapCondition *c){ \
+	if (c) { \
+		return make_shared<UnaryOpMapEntry>(OPCODE, UnaryOperator::OPENUM, c); \
+	} else { \
+		return make_shared<UnaryOpMapEntry>(OPCODE, UnaryOperator::OPENUM); \
+	}\
+})
 #define COMPOP_ENTRY(OPCODE, IS_INTEGER) make_pair(OPCODE, [](MapCondition *c){ \
 	if (c) { \
 		return make_shared<CompOpMapEntry>(OPCODE, IS_INTEGER, c); \
@@ -92,6 +97,14 @@
 	}\
 })
 
+#define INTRINSIC_ENTRY(OPCODE, ID) make_pair(OPCODE, [](MapCondition *c){ \
+	if (c) { \
+		return make_shared<IntrinsicMapEntry>(OPCODE, Intrinsic::ID, c); \
+	} else { \
+		return make_shared<IntrinsicMapEntry>(OPCODE, Intrinsic::ID); \
+	}\
+})
+
 // Key setting to parse the JSON object
 #define INST_KEY		"inst"
 #define MAP_KEY			"map"
@@ -121,8 +134,7 @@ namespace CGRAOmp
 			 * @param map a name which the instruction to be mapped to
 			 */
 			MapCondition(StringRef map) :
-				map_name(map.str()), anyLHS(true),
-				anyRHS(true), anyPred(true) {};
+				map_name(map.str()), anyPred(true) {};
 			/// Copy constructor
 			MapCondition(const MapCondition &) = default;
 			/// Move Constructor
@@ -171,7 +183,30 @@ namespace CGRAOmp
 			 * @return true in the case of satisfying the condition
 			 * @return otherwise false
 			 */
-			bool match(Instruction *I);
+			bool match(Instruction *I) const;
+
+			/// bit assignment of instruction flags
+			enum FlagBit : uint32_t {
+				NUW			= 1 << 0,
+				NSW			= 1 << 1,
+				EXACT		= 1 << 2,
+				NNAN		= 1 << 3,
+				NINF		= 1 << 4,
+				NSZ			= 1 << 5,
+				ARCP		= 1 << 6,
+				CONTRACT	= 1 << 7,
+				AFN			= 1 << 8,
+				REASSOC		= 1 << 9,
+				FAST		= NNAN | NINF | NSZ | ARCP | CONTRACT | AFN | REASSOC,
+			};
+
+			/**
+			 * @brief extract all the flags of the instruction as a bitmask
+			 * 
+			 * @param I an instruction
+			 * @return uint32_t a word of FlagBit
+			 */
+			static uint32_t getFlagWord(Instruction *I);
 
 			/**
 			 * @brief get map name associated with this condition
@@ -189,20 +224,27 @@ namespace CGRAOmp
 				errs() << "\n";
 			}
 		private:
-			/// wrapper for const operand comparison
-			std::function<bool(Instruction*I)> match_use;
+			/// kind of constant operand condition
+			enum class ConstKind : uint8_t {
+				Any,
+				Int,
+				Double,
+			};
 
 			std::string map_name;
-			int use_int;
-			double use_double;
-			SmallVector<StringRef> flag_list;
+			/// flags required for the instruction (a word of FlagBit)
+			uint32_t flag_mask = 0;
+			/// constant operand condition
+			ConstKind const_kind = ConstKind::Any;
+			unsigned const_operand = 0;
+			union {
+				int64_t use_int;
+				double use_double;
+			};
 			CmpInst::Predicate cmp_pred;
-			bool isUseInt = false;
-			bool anyLHS;
-			bool anyRHS;
 			bool anyPred;
-			int const_operand;
 
+			SmallVector<StringRef> flag_list;
 			StringRef pred_str;
 
 			/**
@@ -218,9 +260,9 @@ namespace CGRAOmp
 					* fmax(1, fmax(fabs(a), fabs(b))));
 			}
 
-			/// look-up table of functions to get flag from an inputed instruction
+			/// look-up table of flag bits
 			/// key: string of flag
-			static StringMap<std::function<bool(Instruction*)>> FlagGetter;
+			static StringMap<FlagBit> FlagMap;
 			/// look-up table of an enumeration of predicate
 			/// key: string of predicate
 			static StringMap<CmpInst::Predicate> PredMap;
@@ -251,6 +293,19 @@ namespace CGRAOmp
 	Expected<SmallVector<std::string>> getStringArray(json::Object *json_obj,
 									StringRef key, StringRef filename);
 
+	/**
+	 * @struct OpCost
+	 * @brief cost of an operation executed on the CGRA
+	 */
+	struct OpCost {
+		/// cycles from the input to the output
+		int latency = 1;
+		/// minimum cycles between successive issues of the operation
+		int issue_interval = 1;
+		/// energy per operation (None if it is not specified)
+		Optional<double> energy;
+	};
+
 	/**
 	 * @class InstMapEntry
 	 * @brief An abstract class for an entry to replace IR instruction to targeting CGRA instruction
@@ -259,9 +314,11 @@ namespace CGRAOmp
 		public:
 			enum class InstMapKind {
 				BinaryOp,
+				UnaryOp,
 				CompOp,
 				MemOp,
 				CustomOp,
+				IntrinsicOp,
 				OtherOp
 			};
 
@@ -318,6 +375,20 @@ namespace CGRAOmp
 				return opcode_str == opcode;
 			};
 
+			/**
+			 * @brief an abstract method to get the LLVM IR opcode this entry handles
+			 * It is used to index the entry in InstMap.
+			 * @return an enumeration value of Instruction opcode
+			 */
+			virtual unsigned getIROpcode() const = 0;
+
+			/**
+			 * @brief get the opcode string of this entry
+			 */
+			StringRef getOpcodeName() const {
+				return opcode_str;
+			}
+
 			/**
 			 * @brief get the map name of this entry
 			 */
@@ -334,8 +405,23 @@ namespace CGRAOmp
 			InstMapKind getKind() const {
 				return Kind;
 			}
+
+			/**
+			 * @brief Set the cost of the mapped operation
+			 */
+			void setCost(const OpCost &c) {
+				cost = c;
+			}
+
+			/**
+			 * @brief Get the cost of the mapped operation
+			 */
+			const OpCost& getCost() const {
+				return cost;
+			}
 		private:
 			InstMapKind Kind;
+			OpCost cost;
 		protected:
 			MapCondition* map_cond;
 			std::string opcode_str;
@@ -376,6 +462,10 @@ namespace CGRAOmp
 			 */
 			bool match(Instruction *I);
 
+			unsigned getIROpcode() const {
+				return ops;
+			}
+
 			static bool classof(const InstMapEntry* imap) {
 				return imap->getKind() == BinaryOp;
 			}
@@ -383,6 +473,50 @@ namespace CGRAOmp
 			Instruction::BinaryOps ops;
 	};
 
+	/**
+	 * @class UnaryOpMapEntry
+	 *  @brief A derived class from InstMapEntry for UnaryOperation
+	 */
+	class UnaryOpMapEntry : public InstMapEntry {
+		public:
+			static constexpr InstMapEntry::InstMapKind UnaryOp =
+				 InstMapEntry::InstMapKind::UnaryOp;
+			/**
+			 * @brief Construct a new UnaryOpMapEntry object
+			 * 
+			 * @param opcode string of the instruction opcode
+			 * @param ops a type of unary operations
+			 */
+			UnaryOpMapEntry(StringRef opcode, Instruction::UnaryOps ops) :
+				InstMapEntry(opcode, UnaryOp), ops(ops) {};
+
+			/**
+			 * @brief Construct a new UnaryOpMapEntry object with an initial MapCondition instance
+			 * 
+			 * @param opcode string of the instruction opcode
+			 * @param ops a type of unary operations
+			 * @param cond mapping condition
+			 */
+			UnaryOpMapEntry(StringRef opcode, Instruction::UnaryOps ops,
+								MapCondition* cond) :
+				InstMapEntry(opcode, UnaryOp, cond), ops(ops) {};
+
+			/**
+			 * @brief Derived function from InstMapEntry::match specilized for unary operation
+			 */
+			bool match(Instruction *I);
+
+			unsigned getIROpcode() const {
+				return ops;
+			}
+
+			static bool classof(const InstMapEntry* imap) {
+				return imap->getKind() == UnaryOp;
+			}
+		private:
+			Instruction::UnaryOps ops;
+	};
+
 	/**
 	 * @class CompOpMapEntry
 	 *  @brief A derived class from InstMapEntry for comparison instructions
@@ -425,6 +559,11 @@ namespace CGRAOmp
 			 * @brief Derived function from InstMapEntry::match specilized for comparison instructions
 			 */
 			bool match(Instruction *I);
+
+			unsigned getIROpcode() const {
+				return isInteger ? Instruction::OtherOps::ICmp :
+									Instruction::OtherOps::FCmp;
+			}
 		private:
 			bool isInteger;
 	};
@@ -466,6 +605,10 @@ namespace CGRAOmp
 			 * @brief Derived function from InstMapEntry::match specilized for memory operation
 			 */
 			bool match(Instruction *I);
+
+			unsigned getIROpcode() const {
+				return mem_kind;
+			}
 		private:
 			Instruction::MemoryOps mem_kind;
 	};
@@ -482,22 +625,17 @@ namespace CGRAOmp
 			 * @brief Construct a new CustomIns MapEntry object
 			 * 
 			 * @param func_name a function name correspoinding to the custom instruction
-			 * @param MAM ModuleAnalysisManager
 			 */
-			CustomInstMapEntry(StringRef func_name, 
-								ModuleAnalysisManager &MAM) : 
-								InstMapEntry(func_name, CustomOp), MAM(MAM) {};
+			CustomInstMapEntry(StringRef func_name) :
+								InstMapEntry(func_name, CustomOp) {};
 			/**
 			 * @brief Construct a new CustomInstMapEntry object with an initial MapCondition instance
 			 * 
 			 * @param func_name a function name correspoinding to the custom instruction
-			 * @param MAM ModuleAnalysisManager
 			 * @param cond mapping condition
 			 */
-			CustomInstMapEntry(StringRef func_name, 
-								ModuleAnalysisManager &MAM,
-								MapCondition* map_cond) :
-				InstMapEntry(func_name, CustomOp, map_cond), MAM(MAM) {};
+			CustomInstMapEntry(StringRef func_name, MapCondition* map_cond) :
+				InstMapEntry(func_name, CustomOp, map_cond) {};
 
 			static bool classof(const InstMapEntry* imap) {
 				return imap->getKind() == CustomOp;
@@ -508,9 +646,62 @@ namespace CGRAOmp
 			 */
 			bool match(Instruction *I);
 
+			/// custom instructions are always function calls
+			unsigned getIROpcode() const {
+				return Instruction::OtherOps::Call;
+			}
+	};
+
+	/**
+	 * @class IntrinsicMapEntry
+	 *  @brief A derived class from InstMapEntry for intrinsic function calls
+	 */
+	class IntrinsicMapEntry : public InstMapEntry {
+		public:
+			static constexpr InstMapEntry::InstMapKind IntrinsicOp =
+				InstMapEntry::InstMapKind::IntrinsicOp;
+			/**
+			 * @brief Construct a new IntrinsicMapEntry object
+			 * 
+			 * @param opcode string of the instruction opcode
+			 * @param id intrinsic ID
+			 */
+			IntrinsicMapEntry(StringRef opcode, Intrinsic::ID id) :
+				InstMapEntry(opcode, IntrinsicOp), id(id) {};
+
+			/**
+			 * @brief Construct a new IntrinsicMapEntry object with an initial MapCondition instance
+			 * 
+			 * @param opcode string of the instruction opcode
+			 * @param id intrinsic ID
+			 * @param cond mapping condition
+			 */
+			IntrinsicMapEntry(StringRef opcode, Intrinsic::ID id,
+								MapCondition* cond) :
+				InstMapEntry(opcode, IntrinsicOp, cond), id(id) {};
+
+			static bool classof(const InstMapEntry* imap) {
+				return imap->getKind() == IntrinsicOp;
+			}
+
+			/**
+			 * @brief Derived function from InstMapEntry::match specilized for intrinsic calls
+			 */
+			bool match(Instruction *I);
+
+			/// intrinsics are also function calls
+			unsigned getIROpcode() const {
+				return Instruction::OtherOps::Call;
+			}
+
+			/**
+			 * @brief Get the intrinsic ID of this entry
+			 */
+			Intrinsic::ID getIntrinsicID() const {
+				return id;
+			}
 		private:
-			bool isCustomOpFunc(Function *F);
-			ModuleAnalysisManager &MAM;
+			Intrinsic::ID id;
 	};
 
 	/**
@@ -570,6 +761,8 @@ namespace CGRAOmp
 			 */
 			bool match(Instruction *I);
 
+			unsigned getIROpcode() const;
+
 			static bool classof(const InstMapEntry* imap) {
 				return imap->getKind() == OtherOp;
 			}
@@ -624,9 +817,8 @@ namespace CGRAOmp
 			 * @brief add a custom instruction
 			 * 
 			 * @param opcode opcode string of the instruction (= the corresponding function name)
-			 * @param MAM ModuleAnalysisManager
 			 */
-			void add_custom_inst(StringRef opcode, ModuleAnalysisManager &MAM);
+			void add_custom_inst(StringRef opcode);
 
 			/**
 			 * @brief add an entry with a mapping condition
@@ -637,6 +829,34 @@ namespace CGRAOmp
 			 */
 			Error add_map_entry(StringRef opcode, MapCondition* map_cond);
 
+			/**
+			 * @brief build the dispatch table used by find(Instruction*)
+			 * It is called once all the entries are added.
+			 * If the entries are modified afterward, the table is rebuilt at the next lookup.
+			 */
+			void buildIndex();
+
+			/**
+			 * @brief set the functions annotated as custom instructions in the module
+			 * Only calls of these functions are matched with the custom instruction entries.
+			 * @param funcs a list of the annotated functions
+			 */
+			void setCustomInstFunctions(ArrayRef<Function*> funcs);
+
+			/**
+			 * @brief set the cost to all the entries
+			 * 
+			 * @param get_cost a function returning the cost for a map name
+			 */
+			void setCost(function_ref<OpCost(StringRef)> get_cost);
+
+			/**
+			 * @brief get the map names of all the entries
+			 * 
+			 * @return StringSet<> a set of the map names
+			 */
+			StringSet<> getMapNames();
+
 		private:
 			using entry_ptr = std::shared_ptr<InstMapEntry>;
 			using entry_iterator = SmallVector<entry_ptr>::iterator;
@@ -649,6 +869,21 @@ namespace CGRAOmp
 			SmallVector<entry_ptr> entries;
 			StringMap<entry_ptr> defaultEntries;
 
+			/// candidate entries for each opcode in the order of addition
+			using entry_list = SmallVector<InstMapEntry*, 2>;
+			/// dispatch table indexed by LLVM IR opcode
+			SmallVector<entry_list, 0> opcode_index;
+			/// functions annotated as custom instructions
+			SmallVector<Function*> custom_funcs;
+			/// dispatch table for custom instructions
+			/// key: function annotated as the custom instruction
+			DenseMap<Function*, entry_list> custom_index;
+			/// dispatch table for intrinsic calls
+			/// key: intrinsic ID
+			DenseMap<unsigned, entry_list> intrinsic_index;
+			/// true if the dispatch tables are consistent with the entries
+			bool index_valid = false;
+
 	};
 
 } // namespace CGRAOmp
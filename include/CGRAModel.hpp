@@ -56,6 +56,27 @@
 #define CUSTOM_INST_KEY	"custom_instructions"
 #define GEN_INST_KEY	"generic_instructions"
 #define INST_MAP_KEY	"instruction_map"
+#define LOOP_COUNTER_KEY	"loop_counter"
+#define DELAY_LINE_KEY	"delay_line"
+#define REG_BUDGET_KEY	"register_budget"
+#define MEM_WIDTH_KEY	"memory_access_width"
+#define MEM_BANK_KEY	"memory_bank"
+#define BANK_NUM_KEY	"num_banks"
+#define BANK_PORT_KEY	"ports_per_bank"
+#define MIN_TRIP_COUNT_KEY	"min_offload_trip_count"
+#define OP_COST_KEY		"op_cost"
+#define OP_LATENCY_KEY	"latency"
+#define OP_II_KEY		"issue_interval"
+#define OP_ENERGY_KEY	"energy"
+#define OP_DEFAULT_KEY	"default"
+#define PE_CLASS_KEY	"pe_classes"
+#define PE_NAME_KEY		"name"
+#define PE_OPS_KEY		"ops"
+#define PE_COUNT_KEY	"count"
+#define PE_POS_KEY		"positions"
+
+// the maximum number of PE classes in a model
+#define MAX_PE_CLASSES	16
 
 
 
@@ -64,6 +85,21 @@ using namespace llvm;
 namespace CGRAOmp
 {
 
+	/**
+	 * @struct PEClass
+	 * @brief A group of processing elements sharing the same set of operations
+	 */
+	struct PEClass {
+		/// name of the class
+		std::string name;
+		/// map names of the operations executable on the PEs
+		StringSet<> ops;
+		/// the number of PEs
+		int count = 0;
+		/// grid positions (x, y) of the PEs (optional)
+		SmallVector<std::pair<int,int>> positions;
+	};
+
 	/**
 	 * @class CGRAModel
 	 * @brief A base class of CGRA model for DFG extraction
@@ -106,12 +142,27 @@ namespace CGRAOmp
 				/// Replacing the inter-loop dependency with backward operation node
 				BackwardInst,
 			};
+			/**
+			 * @enum DelayLineStyle
+			 * @brief How to carry a value over more than one iteration
+			 */
+			enum class DelayLineStyle {
+				/// only dependencies with distance 1 are allowed
+				No,
+				/// a chain of delay registers, each of which holds the value for one iteration
+				RegisterChain,
+				/// a single back-edge annotated with its distance
+				DistanceEdge,
+			};
+
 			/// Map category string to CGRACategory
 			static StringMap<CGRACategory> CategoryMap;
 			/// Map category string to ConditionalStyle
 			static StringMap<ConditionalStyle> CondStyleMap;
 			/// Map category string to InterLoopDep
 			static StringMap<InterLoopDep> InterLoopDepMap;
+			/// Map category string to DelayLineStyle
+			static StringMap<DelayLineStyle> DelayLineStyleMap;
 
 			// constructors
 			/**
@@ -148,9 +199,8 @@ namespace CGRAOmp
 			 * 
 			 * @param opcode opcode of the instruction
 			 * 	- if it is already added instruction, this function does nothing
-			 * @param MAM ModuleAnalysisManager
 			 */
-			void addCustomInst(StringRef opcode, ModuleAnalysisManager &MAM);
+			void addCustomInst(StringRef opcode);
 
 			/**
 			 * @brief add a instruction mapping entry to the CGRA model
@@ -161,6 +211,14 @@ namespace CGRAOmp
 			 */
 			Error add_map_entry(StringRef opcode, MapCondition *map_cond);
 
+			/**
+			 * @brief build the opcode-indexed dispatch table of the instruction mapping
+			 * It should be called after all the entries are added.
+			 * @param M Module containing the functions annotated as custom instructions
+			 * @param MAM ModuleAnalysisManager
+			 */
+			void buildInstMapIndex(Module &M, ModuleAnalysisManager &MAM);
+
 			/**
 			 * @brief checking whether the instruction is supported by the CGRA or not.
 			 * 
@@ -199,12 +257,228 @@ namespace CGRAOmp
 				return inter_loop_dep;
 			}
 
+			/**
+			 * @brief Set the availability of hardware loop counters
+			 * 
+			 * @param enable true if the CGRA has loop counters
+			 */
+			void setLoopCounter(bool enable) {
+				loop_counter = enable;
+			}
+
+			/**
+			 * @brief check if the CGRA has hardware loop counters
+			 * @details If so, induction variables are mapped to counter nodes
+			 * instead of add nodes with self loops.
+			 * 
+			 * @return true if loop counters are available
+			 */
+			bool hasLoopCounter() const {
+				return loop_counter;
+			}
+
+			/**
+			 * @brief Set the delay line style and its register budget
+			 * 
+			 * @param style how to carry a value over more than one iteration
+			 * @param budget the number of delay registers available in a loop
+			 */
+			void setDelayLine(DelayLineStyle style, int budget = INT_MAX) {
+				delay_style = style;
+				register_budget = budget;
+			}
+
+			/**
+			 * @brief Get the delay line style
+			 * 
+			 * @return DelayLineStyle 
+			 */
+			DelayLineStyle getDelayLineStyle() const {
+				return delay_style;
+			}
+
+			/**
+			 * @brief Get the maximum distance of loop-carried dependency
+			 * which can be kept in registers
+			 * @details A dependency with distance @f$ d @f$ occupies @f$ d-1 @f$ delay registers
+			 * because the def node itself holds the value of the previous iteration.
+			 * Thus, it is limited by the register budget if delay lines are available.
+			 *
+			 * @return int the maximum distance
+			 */
+			int getMaxDependencyDistance() const {
+				if (delay_style == DelayLineStyle::No) {
+					return 1;
+				}
+				return (register_budget == INT_MAX) ? INT_MAX : register_budget + 1;
+			}
+
+			/**
+			 * @brief Get the number of delay registers shared by all the dependencies in a loop
+			 *
+			 * @return int the budget (0 if delay lines are not available)
+			 */
+			int getRegisterBudget() const {
+				return (delay_style == DelayLineStyle::No) ? 0 : register_budget;
+			}
+
+			/**
+			 * @brief Set the maximum bit width of a single memory access
+			 * 
+			 * @param width bit width (0 means only scalar accesses)
+			 */
+			void setMaxMemAccessWidth(int width) {
+				mem_access_width = width;
+			}
+
+			/**
+			 * @brief Get the maximum bit width of a single memory access
+			 * @details Adjacent accesses can be merged into a wide access
+			 * as long as the total width does not exceed it.
+			 * 
+			 * @return int bit width (0 means only scalar accesses)
+			 */
+			int getMaxMemAccessWidth() const {
+				return mem_access_width;
+			}
+
+			/**
+			 * @brief Set the minimum trip count to be offloaded
+			 * 
+			 * @param count trip count (0 means offloading is always profitable)
+			 */
+			void setMinOffloadTripCount(int count) {
+				min_offload_trip_count = count;
+			}
+
+			/**
+			 * @brief Get the minimum trip count to be offloaded
+			 * @details Below this count, the overheads of configuration and data transfer
+			 * exceed the speedup by the CGRA so that the host executes the kernel instead.
+			 * 
+			 * @return int trip count (0 means offloading is always profitable)
+			 */
+			int getMinOffloadTripCount() const {
+				return min_offload_trip_count;
+			}
+
+			/**
+			 * @brief Set the cost table of the mapped operations
+			 * 
+			 * @param table costs for each map name
+			 * @param default_cost cost for the operations not in the table
+			 */
+			void setOpCostTable(const StringMap<OpCost> &table,
+								const OpCost &default_cost);
+
+			/**
+			 * @brief Get the cost of the mapped operation
+			 * 
+			 * @param map_name name of the operation in the DFG
+			 * @return const OpCost& the cost. The default cost is returned if it is not in the table.
+			 */
+			const OpCost& getOpCost(StringRef map_name) const {
+				auto it = op_cost.find(map_name);
+				return (it != op_cost.end()) ? it->second : default_op_cost;
+			}
+
+			/**
+			 * @brief Get the cost of the instruction executed on the CGRA
+			 * 
+			 * @param I an instruction
+			 * @return Optional<OpCost> the cost if the instruction is supported. Otherwise, None.
+			 */
+			Optional<OpCost> getOpCost(Instruction *I) {
+				if (auto *imap = isSupported(I)) {
+					return imap->getCost();
+				}
+				return None;
+			}
+
+			/**
+			 * @brief Get the latency of the mapped operation
+			 */
+			int getLatency(StringRef map_name) const {
+				return getOpCost(map_name).latency;
+			}
+
+			/**
+			 * @brief Get the issue interval of the mapped operation
+			 */
+			int getIssueInterval(StringRef map_name) const {
+				return getOpCost(map_name).issue_interval;
+			}
+
+			/**
+			 * @brief check if the model has a cost table
+			 * @details Without the table, every operation has the default cost (latency 1 and issue interval 1).
+			 * A table only with the default cost is also regarded as a table.
+			 */
+			bool hasOpCostTable() const {
+				return has_op_cost;
+			}
+
+			/**
+			 * @brief Set the heterogeneous PE classes of the array
+			 * 
+			 * @param classes list of the PE classes
+			 */
+			void setPEClasses(ArrayRef<PEClass> classes) {
+				pe_classes.assign(classes.begin(), classes.end());
+			}
+
+			/**
+			 * @brief check if the model declares PE classes
+			 * @details Otherwise, every PE is assumed to execute all the supported operations.
+			 */
+			bool hasPEClasses() const {
+				return !pe_classes.empty();
+			}
+
+			/// get the list of the PE classes
+			ArrayRef<PEClass> getPEClasses() const {
+				return pe_classes;
+			}
+
+			/**
+			 * @brief Get the bit mask of the PE classes able to execute the operation
+			 * 
+			 * @param map_name name of the operation in the DFG
+			 * @return unsigned i-th bit is set if the i-th class supports the operation
+			 */
+			unsigned getPEClassMask(StringRef map_name) const;
+
+			/**
+			 * @brief Get the names of the PE classes able to execute the operation
+			 * 
+			 * @param map_name name of the operation in the DFG
+			 * @return SmallVector<StringRef> the class names in the declared order
+			 */
+			SmallVector<StringRef> getPEClassNames(StringRef map_name) const;
+
+			/**
+			 * @brief check if the operations of a kernel fit the PE classes
+			 * 
+			 * @param demand the number of operations for each map name
+			 * @return Optional<std::string> a reason if the kernel cannot be mapped. Otherwise, None.
+			 */
+			Optional<std::string> checkPEDemand(const StringMap<unsigned> &demand) const;
+
 		protected:
 			StringRef filename;
 			ConditionalStyle cond;
 			InterLoopDep inter_loop_dep;
 			CGRACategory category;
 			InstMap inst_map;
+			bool loop_counter = false;
+			DelayLineStyle delay_style = DelayLineStyle::No;
+			int register_budget = INT_MAX;
+			int mem_access_width = 0;
+			int min_offload_trip_count = 0;
+			StringMap<OpCost> op_cost;
+			OpCost default_op_cost;
+			bool has_op_cost = false;
+			SmallVector<PEClass> pe_classes;
 
 	};
 
@@ -273,12 +547,43 @@ namespace CGRAOmp
 				return AG;
 			}
 
+			/**
+			 * @brief Set the memory bank configuration
+			 * 
+			 * @param banks the number of memory banks
+			 * @param ports the number of streams each bank can serve in parallel
+			 */
+			void setMemoryBank(int banks, int ports) {
+				num_banks = banks;
+				ports_per_bank = ports;
+			}
+
+			/**
+			 * @brief check if the memory bank configuration is specified
+			 * @details Otherwise, all the streams are assumed to share one memory without any port limitation.
+			 */
+			bool hasMemoryBank() const {
+				return num_banks > 0;
+			}
+
+			/// get the number of memory banks
+			int getNumBanks() const {
+				return hasMemoryBank() ? num_banks : 1;
+			}
+
+			/// get the number of streams each bank can serve in parallel
+			int getPortsPerBank() const {
+				return hasMemoryBank() ? ports_per_bank : INT_MAX;
+			}
+
 			/// for downcasting from CGRAModel by llvm::dyn_cast
 			static bool classof(const CGRAModel *M) {
 				return M->getKind() == CGRACategory::Decoupled;
 			}
 		private:
 			AddressGenerator *AG;
+			int num_banks = 0;
+			int ports_per_bank = 1;
 
 	};
 
@@ -487,11 +792,12 @@ namespace CGRAOmp
 	 * @brief a helper function to instantiate CGRAModel based on JSON configfile
 	 * 
 	 * @param filepath filepath to the JSON config file
+	 * @param M Module to be compiled
 	 * @param MAM ModuleAnalysisManager
 	 * @return Expected<CGRAModel> CGRAModel if there is no error. Otherwise, it contains ModelError
 	 */
 	Expected<CGRAModel*> parseCGRASetting(StringRef filepath,
-											ModuleAnalysisManager &MAM);
+											Module &M, ModuleAnalysisManager &MAM);
 
 	/**
 	 * @brief a template to extract only values from SettingMap
@@ -560,6 +866,49 @@ namespace CGRAOmp
 	Expected<AddressGenerator*>  createAffineAG(json::Object *json_obj,
 												StringRef filename);
 
+	/**
+	 * @brief Get the register budget for delay lines from JSON config
+	 * 
+	 * @param json_obj JSON object of the delay line setting
+	 * @param filename filename of JSON config (just for error message)
+	 * @return Expected<int> the budget if there is no error. Otherwise, it contains ModelError
+	 * If it is not specified, INT_MAX is returned, i.e., no limitation.
+	 */
+	Expected<int> getRegisterBudget(json::Object *json_obj, StringRef filename);
+
+	/**
+	 * @brief Get the memory bank configuration from JSON config
+	 * 
+	 * @param json_obj JSON object of the memory bank setting
+	 * @param filename filename of JSON config (just for error message)
+	 * @return Expected<std::pair<int,int>> a pair of the number of banks and ports per bank if there is no error. Otherwise, it contains ModelError
+	 * If the number of ports is not specified, it is 1.
+	 */
+	Expected<std::pair<int,int>> getMemoryBank(json::Object *json_obj,
+												StringRef filename);
+
+	/**
+	 * @brief Get the cost table of operations from JSON config
+	 * 
+	 * @param json_obj JSON object of the cost setting
+	 * @param filename filename of JSON config (just for error message)
+	 * @return Expected<StringMap<OpCost>> costs for each map name if there is no error. Otherwise, it contains ModelError
+	 * The cost for the key "default" is applied to the operations not in the table.
+	 */
+	Expected<StringMap<OpCost>> getOpCostTable(json::Object *json_obj,
+												StringRef filename);
+
+	/**
+	 * @brief Get the PE classes from JSON config
+	 * 
+	 * @param json_arr JSON array of the PE class settings
+	 * @param filename filename of JSON config (just for error message)
+	 * @return Expected<SmallVector<PEClass>> the PE classes if there is no error. Otherwise, it contains ModelError
+	 * If the count is omitted, it is the number of the positions.
+	 */
+	Expected<SmallVector<PEClass>> getPEClasses(json::Array *json_arr,
+												StringRef filename);
+
 	using AGGen_t = std::function<Expected<AddressGenerator*>(json::Object*,StringRef)>;
 
 } // namespace CGRAOmp
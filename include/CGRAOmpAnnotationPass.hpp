@@ -67,7 +67,6 @@ namespace CGRAOmp {
 				}
 				/// interface for DenseMap.find
 				ResultBase::iterator find(Function *F) {
-					auto hoge = result[F];
 					return result.find(F);
 				}
 				/// interface for DenseMap.end
@@ -104,6 +103,14 @@ namespace CGRAOmp {
 			static AnalysisKey Key;
 	};
 
+	/**
+	 * @brief register the annotation analyses to the pass builder
+	 * @remarks It is used as the plugin entry and by tools linking CGRAOmp statically
+	 *
+	 * @param PB PassBuilder
+	 */
+	void registerAnnotationPasses(PassBuilder &PB);
+
 }
 
 #endif //CGRAOmpAnnotationPass_H
\ No newline at end of file
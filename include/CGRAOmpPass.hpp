@@ -37,6 +37,7 @@
 #include "llvm/IR/Value.h"
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Passes/PassPlugin.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/Support/Error.h"
@@ -68,10 +69,30 @@ using namespace llvm;
 namespace CGRAOmp {
 
 
+	/**
+	 * @struct ModelSummary
+	 * @brief Statistics of the compilation for a CGRA model
+	 */
+	struct ModelSummary {
+		/// the number of OpenMP kernels
+		unsigned kernels = 0;
+		/// the number of loops passing the verification
+		unsigned verified = 0;
+		/// the number of exported DFGs
+		unsigned dfgs = 0;
+		/// the total number of DFG nodes
+		unsigned nodes = 0;
+		/// the total number of DFG edges
+		unsigned edges = 0;
+	};
+
 	/**
 	 * @class ModelManager
 	 * @brief An interface for each LLVM pass to get the target CGRAModel.
 	 * It can be obtained as an analysis result of ModelManagerPass.
+	 * @details More than one model can be managed for design space exploration.
+	 * Only one of them is selected at a time, and the selection is shared with
+	 * all the copies of this manager (e.g., the results of the proxies).
 	*/
 	class ModelManager {
 		public:
@@ -81,23 +102,97 @@ namespace CGRAOmp {
 			 * 
 			 * @param CM a generated CGRAModel
 			 */
-			explicit ModelManager(CGRAModel *CM) : model(CM) {};
+			explicit ModelManager(CGRAModel *CM) :
+				ModelManager(ArrayRef<CGRAModel*>(CM), {""}) {};
+			/**
+			 * @brief Construct a new ModelManager object for several models
+			 * 
+			 * @param CMs generated CGRAModels
+			 * @param names names of the models used for the output directories
+			 */
+			ModelManager(ArrayRef<CGRAModel*> CMs, ArrayRef<std::string> names);
 			/// copy constructor
 			ModelManager(const ModelManager&) = default;
 			/// move constructor
 			ModelManager(ModelManager&&) = default;
 			/**
-			 * @brief Get the CGRAModel object
+			 * @brief Get the selected CGRAModel object
 			 * @return CGRAModel* this manger contains
 			 */
-			CGRAModel* getModel() const { return model; }
+			CGRAModel* getModel() const { return state->models[state->active]; }
+
+			/**
+			 * @brief Get the idx-th CGRAModel object
+			 */
+			CGRAModel* getModel(unsigned idx) const { return state->models[idx]; }
+
+			/**
+			 * @brief Get the number of the managed models
+			 */
+			unsigned getNumModels() const { return state->models.size(); }
+
+			/**
+			 * @brief check if more than one model is managed
+			 */
+			bool isMultiModel() const { return getNumModels() > 1; }
+
+			/**
+			 * @brief select the model used by the following passes
+			 * 
+			 * @param idx index of the model
+			 */
+			void selectModel(unsigned idx) {
+				assert(idx < getNumModels() && "model index out of range");
+				state->active = idx;
+			}
+
+			/**
+			 * @brief Get the index of the selected model
+			 */
+			unsigned getSelectedIndex() const { return state->active; }
+
+			/**
+			 * @brief Get the name of the idx-th model
+			 */
+			StringRef getModelName(unsigned idx) const { return state->names[idx]; }
+
+			/**
+			 * @brief Get the name of the selected model
+			 */
+			StringRef getModelName() const { return getModelName(state->active); }
+
+			/**
+			 * @brief Get the summary of the idx-th model
+			 */
+			ModelSummary& getSummary(unsigned idx) { return state->summaries[idx]; }
+
+			/**
+			 * @brief Get the summary of the selected model
+			 */
+			ModelSummary& getSummary() { return getSummary(state->active); }
+
+			/**
+			 * @brief Get the output path for the selected model
+			 * @details In the case of more than one model, the file is placed in
+			 * a directory named after the model, which is created if it does not exist.
+			 * 
+			 * @param path original output path
+			 * @return std::string the output path
+			 */
+			std::string getOutputPath(StringRef path) const;
 
 			/// implemented for enabling getCacheResult from inner modules
 			template <typename IRUnitT, typename InvT>
 			bool invalidate(IRUnitT& IR, const PreservedAnalyses &PA,
 								InvT &Inv);
 		private:
-			CGRAModel* model;
+			struct State {
+				SmallVector<CGRAModel*> models;
+				SmallVector<std::string> names;
+				SmallVector<ModelSummary> summaries;
+				unsigned active = 0;
+			};
+			std::shared_ptr<State> state;
 	};
 
 	/**
@@ -143,6 +238,68 @@ namespace CGRAOmp {
 			static AnalysisKey Key;
 	};
 
+	/**
+	 * @class InstMapInfo
+	 * @brief A memoized result of instruction mapping for each instruction in a function
+	 */
+	class InstMapInfo {
+		public:
+			/**
+			 * @brief Get the mapping entry for the instruction
+			 *
+			 * @param I an instruction
+			 * @return InstMapEntry* if the instruction is supported by the CGRA, otherwise nullptr
+			 */
+			InstMapEntry* getEntry(Instruction *I) const {
+				auto it = entry_map.find(I);
+				return (it != entry_map.end()) ? it->second.first : nullptr;
+			}
+
+			/**
+			 * @brief Get the map name for the instruction
+			 *
+			 * @param I an instruction
+			 * @return StringRef of the map name. It is empty if the instruction is not supported
+			 */
+			StringRef getMapName(Instruction *I) const {
+				auto it = entry_map.find(I);
+				return (it != entry_map.end()) ? StringRef(it->second.second) : StringRef();
+			}
+
+			/**
+			 * @brief Check if the instruction is supported by the CGRA
+			 */
+			bool isSupported(Instruction *I) const {
+				return entry_map.count(I) > 0;
+			}
+
+			/**
+			 * @brief register the mapping entry of the instruction
+			 */
+			void insert(Instruction *I, InstMapEntry *entry) {
+				entry_map[I] = std::make_pair(entry, entry->getMapName());
+			}
+
+			bool invalidate(Function &F, const PreservedAnalyses &PA,
+							FunctionAnalysisManager::Invalidator &Inv);
+		private:
+			DenseMap<Instruction*,std::pair<InstMapEntry*,std::string>> entry_map;
+	};
+
+	/**
+	 * @class InstMapAnalysisPass
+	 * @brief A function analysis to classify all the instructions with the instruction map of the CGRA model
+	 * @remark The result is shared by the verification and the DFG generation so that each instruction is matched only once
+	 */
+	class InstMapAnalysisPass : public AnalysisInfoMixin<InstMapAnalysisPass> {
+		public:
+			using Result = InstMapInfo;
+			Result run(Function &F, FunctionAnalysisManager &AM);
+		private:
+			friend AnalysisInfoMixin<InstMapAnalysisPass>;
+			static AnalysisKey Key;
+	};
+
 	/**
 	 * @class OmpKernelInfo
 	 * @brief A set of information regarding OpenMP target kernel
@@ -201,12 +358,35 @@ namespace CGRAOmp {
 			 * 
 			 * @param offload Offloading function corresponding to the target region
 			 * @param kernel Outlined function for the kernel
+			 * 	- if it is already added kernel, this function does nothing
 			 */
 			void add_kernel(Function *offload, Function *kernel) {
+				if (!kernel_index.insert({kernel, kernel_list.size()}).second) {
+					return;
+				}
 				kernel_list.emplace_back(kernel);
 				offload_func_list.emplace_back(offload);
 			}
 
+			/**
+			 * @brief check if the function is a kernel
+			 */
+			bool isKernel(Function *F) const {
+				return kernel_index.count(F);
+			}
+
+			/**
+			 * @brief Get the ID of the kernel
+			 * @details The ID is the order of discovery, which is stable while the result is valid.
+			 * 
+			 * @param kernel kernel function
+			 * @return int the ID if it is a kernel. Otherwise, -1
+			 */
+			int getKernelID(Function *kernel) const {
+				auto it = kernel_index.find(kernel);
+				return (it != kernel_index.end()) ? it->second : -1;
+			}
+
 			/**
 			 * @brief Get the Offload Function pointer from the kernel function
 			 * 
@@ -214,12 +394,8 @@ namespace CGRAOmp {
 			 * @return Function* the offloading function
 			 */
 			Function* getOffloadFunction(Function *kernel) {
-				auto kernel_it = kernel_begin();
-				auto offload_it = offload_func_list.begin(); 
-				for (;kernel_it != kernel_end(); kernel_it++, offload_it++) {
-					if (kernel == *kernel_it) return *offload_it;
-				}
-				return nullptr;
+				auto ID = getKernelID(kernel);
+				return (ID >= 0) ? offload_func_list[ID] : nullptr;
 			}
 
 			/**
@@ -250,6 +426,10 @@ namespace CGRAOmp {
 			MetadataList md_list;
 			FunctionList kernel_list;
 			FunctionList offload_func_list;
+			/// kernel -> its ID (index of kernel_list)
+			DenseMap<Function*, unsigned> kernel_index;
+			/// name of the offloading function -> index of md_list
+			StringMap<unsigned> md_index;
 
 	};
 
@@ -373,6 +553,42 @@ namespace CGRAOmp {
 			PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
 	};
 
+	/**
+	 * @class SelectModelPass
+	 * @brief Module Pass to switch the CGRA model used by the following passes
+	 * @details The analysis results depending on the model are invalidated,
+	 * while the IR and its pre-optimization are shared among the models.
+	 */
+	class SelectModelPass : public PassInfoMixin<SelectModelPass> {
+		public:
+			/**
+			 * @brief Construct a new SelectModelPass object
+			 * 
+			 * @param idx index of the model to be selected
+			 */
+			explicit SelectModelPass(unsigned idx) : idx(idx) {};
+			PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
+		private:
+			unsigned idx;
+	};
+
+	/**
+	 * @class ModelSummaryPass
+	 * @brief Module Pass to save a summary table of all the models
+	 */
+	class ModelSummaryPass : public PassInfoMixin<ModelSummaryPass> {
+		public:
+			PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
+	};
+
+	/**
+	 * @brief register the cgraomp pipelines and the OpenMP analyses to the pass builder
+	 * @remarks It is used as the plugin entry and by tools linking CGRAOmp statically
+	 *
+	 * @param PB PassBuilder
+	 */
+	void registerCGRAOmpPasses(PassBuilder &PB);
+
 }
 
 #endif //CGRAOmpPass_H
\ No newline at end of file
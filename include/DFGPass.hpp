@@ -37,9 +37,12 @@
 #include "llvm/Passes/PassPlugin.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/iterator_range.h"
+#include "llvm/Support/JSON.h"
 
 #include "CGRAModel.hpp"
 #include "CGRADataFlowGraph.hpp"
+#include "KernelFusion.hpp"
+#include "BankAssignmentAnalysis.hpp"
 
 using namespace llvm;
 
@@ -260,6 +263,42 @@ namespace CGRAOmp {
 										LoopAnalysisManager &LAM, 
 										LoopStandardAnalysisResults &AR);
 
+			/**
+			 * @brief save the list of the exported DFGs as JSON file
+			 * 
+			 * @param filepath filepath of the save file
+			 * @param entries pairs of the kernel weight and the information of the DFG
+			 * @param rejected kernels rejected by the verification
+			 * @return Error in the case of failure in creating a new file
+			 */
+			Error saveManifest(StringRef filepath,
+				SmallVectorImpl<std::pair<double, json::Object>> &entries,
+				ArrayRef<json::Object> rejected);
+
+			/**
+			 * @brief fuse the DFG of a consumer kernel into that of the producer
+			 * @details The consumer loads listed in the candidate are replaced with the values stored by the producer.
+			 * The producer stores are kept because the host may read the results.
+			 * 
+			 * @param Producer DFG of the producer kernel
+			 * @param Consumer DFG of the consumer kernel
+			 * @param C fusion candidate
+			 * @return true if the graphs are fused
+			 * @return false if any of the forwarded memory accesses is not found in the DFGs (e.g., it is modified by DFG passes)
+			 */
+			bool fuseDataFlowGraphs(CGRADFG &Producer, CGRADFG &Consumer,
+										FusionCandidate &C);
+
+			/**
+			 * @brief check if the arrays are placed in the same banks as the other kernels
+			 * @details It emits a warning for an array placed in a different bank
+			 * because the data must be moved between the kernels.
+			 * 
+			 * @param BA bank assignment of the kernel
+			 * @param kernel_name name of the kernel for the message
+			 */
+			void checkBankConsistency(const BankAssignment &BA, StringRef kernel_name);
+
 			/**
 			 * @brief check if the instruction is memory access or not
 			 * 
@@ -296,6 +335,35 @@ namespace CGRAOmp {
 				return new ComputeNode(inst, opcode);
 			}
 
+			/**
+			 * @brief create loop counter node
+			 * 
+			 * @param indvar PHINode of the induction variable
+			 * @param start initial value of the counter
+			 * @param step constant step of the counter
+			 * @param bound final value of the counter (nullptr if unknown)
+			 * @param pred predicate comparing the next value with the bound
+			 * @param nest_level nested level of the loop
+			 * @return DFGNode* a pointer to the node
+			 */
+			inline DFGNode* make_counter_node(PHINode *indvar, Value *start,
+									int64_t step, Value *bound,
+									CmpInst::Predicate pred, int nest_level) {
+				return new CounterNode(indvar, start, step, bound, pred, nest_level);
+			}
+
+			/**
+			 * @brief create delay register node
+			 * 
+			 * @param def Value to be delayed
+			 * @param ID unique ID of the node
+			 * @param stage position in the delay chain
+			 * @return DFGNode* a pointer to the node
+			 */
+			inline DFGNode* make_delay_node(Value *def, int ID, int stage) {
+				return new DelayNode(def, ID, stage);
+			}
+
 			/**
 			 * @brief create constant node
 			 * 
@@ -341,6 +409,8 @@ namespace CGRAOmp {
 			DFGPassBuilder *DPB;
 			DFGPassManager *DPM;
 			SmallVector<CGRADFG*> graph_list;
+			/// bank of each array and the kernel which placed it first
+			StringMap<std::pair<int, std::string>> array_banks;
 
 
 	};
@@ -0,0 +1,239 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /include/DataTransferPlan.hpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 04:36:00
+*    Last Modified: 17-10-2026 04:36:00
+*/
+#ifndef DataTransferPlan_H
+#define DataTransferPlan_H
+
+#include "llvm/IR/PassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/iterator_range.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+
+#include <string>
+
+/* map type flags given to __tgt_target* runtime calls */
+#define OMP_TGT_MAPTYPE_TO			0x001
+#define OMP_TGT_MAPTYPE_FROM		0x002
+#define OMP_TGT_MAPTYPE_ALWAYS		0x004
+#define OMP_TGT_MAPTYPE_DELETE		0x008
+#define OMP_TGT_MAPTYPE_PRIVATE		0x080
+#define OMP_TGT_MAPTYPE_LITERAL		0x100
+#define OMP_TGT_MAPTYPE_IMPLICIT	0x200
+
+#define OFFLOAD_MAPTYPES_PREFIX	".offload_maptypes"
+#define OFFLOAD_SIZES_PREFIX	".offload_sizes"
+#define REGION_ID_SUFFIX		".region_id"
+
+using namespace llvm;
+
+namespace CGRAOmp {
+
+	class DataTransferAnalysisPass;
+
+	/**
+	 * @class TransferEntry
+	 * @brief A mapped variable of a target directive and its data movement
+	 */
+	struct TransferEntry {
+		/// underlying object of the mapped variable
+		Value *obj;
+		/// name of the variable ("unknown" if not found)
+		std::string symbol;
+		/// size in bytes (-1 if it is determined at runtime)
+		int64_t size;
+		/// map type flags
+		uint64_t map_type;
+		/// copied from host to device
+		bool to_device = false;
+		/// copied from device to host
+		bool from_device = false;
+		/// already present on the device, so the runtime does not copy it
+		bool resident = false;
+		/// copied back just before by the previous kernel in the same target data region without any host access
+		bool redundant = false;
+		/// the previous kernel using the resident data
+		std::string reused_from = "";
+
+		json::Value toJson() const;
+	};
+
+	/**
+	 * @class TransferEvent
+	 * @brief Data movement caused by a target directive
+	 */
+	class TransferEvent {
+		public:
+			enum class Kind {
+				/// target enter data (or the beginning of target data)
+				Enter,
+				/// target exit data (or the end of target data)
+				Exit,
+				/// target update
+				Update,
+				/// kernel launch by target
+				Kernel,
+			};
+
+			TransferEvent(Kind kind, CallBase *call) : kind(kind), call(call) {};
+
+			Kind getKind() const {
+				return kind;
+			}
+
+			CallBase* getCall() const {
+				return call;
+			}
+
+			/// set the name of the offloading function for kernel launch
+			void setKernelName(StringRef name) {
+				kernel_name = name.str();
+			}
+
+			StringRef getKernelName() const {
+				return kernel_name;
+			}
+
+			void addEntry(TransferEntry E) {
+				entries.emplace_back(std::move(E));
+			}
+
+			SmallVectorImpl<TransferEntry>& getEntries() {
+				return entries;
+			}
+
+			/**
+			 * @brief Get the total bytes of data movement
+			 * 
+			 * @param to_device true for host-to-device, false for device-to-host
+			 * @return int64_t the bytes whose sizes are known at compile time
+			 */
+			int64_t getTransferBytes(bool to_device) const;
+
+			json::Value toJson() const;
+
+		private:
+			Kind kind;
+			CallBase *call;
+			std::string kernel_name = "";
+			SmallVector<TransferEntry> entries;
+	};
+
+	/**
+	 * @class DataTransferPlan
+	 * @brief DataTransferAnalysisPass result
+	 */
+	class DataTransferPlan {
+		public:
+			using EventList = SmallVector<TransferEvent>;
+			using event_iterator = EventList::iterator;
+
+			/// implemented for enabling getCacheResult from inner modules
+			template <typename IRUnitT, typename InvT>
+			bool invalidate(IRUnitT& IR, const PreservedAnalyses &PA,
+								InvT &Inv) {
+				auto PAC = PA.getChecker<DataTransferAnalysisPass>();
+				return !PAC.preservedWhenStateless();
+			}
+
+			inline event_iterator event_begin() {
+				return event_list.begin();
+			}
+			inline event_iterator event_end() {
+				return event_list.end();
+			}
+			inline iterator_range<event_iterator> events() {
+				return make_range(event_begin(), event_end());
+			}
+
+			void add_event(TransferEvent E) {
+				event_list.emplace_back(std::move(E));
+			}
+
+			/**
+			 * @brief save the plan as JSON file
+			 * 
+			 * @param filepath filepath of the save file
+			 * @return Error in the case of failure in creating a new file
+			 */
+			Error saveAsJson(StringRef filepath);
+
+		private:
+			EventList event_list;
+	};
+
+	/**
+	 * @class DataTransferAnalysisPass
+	 * @brief A module pass to analyze data movement by OpenMP map clauses in host code
+	 * @details
+	 * It finds __tgt_target* runtime calls and reads the sizes and map types of the arguments.
+	 * The presence of each variable on the device is tracked in reverse post order of each function
+	 * so that transfers elided by enclosing target data regions are marked as resident.
+	 * In addition, a copy-in by a kernel is marked as redundant if the previous kernel in the same basic block copied back the same variable and the host does not access it between them.
+	 * Both kernels must be in the same enclosing target data region, which can keep the variable on the device between them.
+	 */
+	class DataTransferAnalysisPass :
+			public AnalysisInfoMixin<DataTransferAnalysisPass> {
+		public:
+			using Result = DataTransferPlan;
+			Result run(Module &M, ModuleAnalysisManager &AM);
+		private:
+			friend AnalysisInfoMixin<DataTransferAnalysisPass>;
+			static AnalysisKey Key;
+
+			/**
+			 * @brief make a transfer event from a runtime call
+			 * 
+			 * @param call call instruction of __tgt_target* 
+			 * @return Optional<TransferEvent> the event if the call is a target directive with mapped variables
+			 */
+			Optional<TransferEvent> parseRuntimeCall(CallBase *call);
+
+			/**
+			 * @brief check if the host may access a variable between two instructions in a basic block
+			 */
+			bool mayHostAccess(Instruction *From, Instruction *To, Value *obj);
+	};
+
+	/**
+	 * @class DataTransferReportPass
+	 * @brief A module pass to save the data transfer plan as a JSON report
+	 */
+	class DataTransferReportPass :
+			public PassInfoMixin<DataTransferReportPass> {
+		public:
+			PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
+	};
+}
+
+#endif //DataTransferPlan_H
@@ -0,0 +1,150 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /include/KernelFusion.hpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 04:42:27
+*    Last Modified: 17-10-2026 04:42:27
+*/
+#ifndef KernelFusion_H
+#define KernelFusion_H
+
+#include "llvm/IR/PassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/iterator_range.h"
+
+#include <string>
+
+using namespace llvm;
+
+namespace CGRAOmp {
+
+	class KernelFusionAnalysisPass;
+
+	/**
+	 * @class FusionCandidate
+	 * @brief A pair of consecutive kernels which can be fused into one kernel
+	 */
+	struct FusionCandidate {
+		/// kernel function writing the shared arrays
+		Function *producer;
+		/// kernel loop of the producer
+		Loop *producer_loop;
+		/// kernel function reading the shared arrays
+		Function *consumer;
+		/// kernel loop of the consumer
+		Loop *consumer_loop;
+		/// loads of the consumer and the stores of the producer forwarding the data to them
+		DenseMap<LoadInst*, StoreInst*> forward;
+		/// symbols of the arrays passed from the producer to the consumer
+		SmallVector<std::string> shared;
+	};
+
+	/**
+	 * @class KernelFusionInfo
+	 * @brief KernelFusionAnalysisPass result
+	 */
+	class KernelFusionInfo {
+		public:
+			using CandidateList = SmallVector<FusionCandidate>;
+			using candidate_iterator = CandidateList::iterator;
+
+			/// implemented for enabling getCacheResult from inner modules
+			template <typename IRUnitT, typename InvT>
+			bool invalidate(IRUnitT& IR, const PreservedAnalyses &PA,
+								InvT &Inv) {
+				auto PAC = PA.getChecker<KernelFusionAnalysisPass>();
+				return !PAC.preservedWhenStateless();
+			}
+
+			inline candidate_iterator candidate_begin() {
+				return candidate_list.begin();
+			}
+			inline candidate_iterator candidate_end() {
+				return candidate_list.end();
+			}
+			inline iterator_range<candidate_iterator> candidates() {
+				return make_range(candidate_begin(), candidate_end());
+			}
+
+			void add_candidate(FusionCandidate C) {
+				candidate_list.emplace_back(std::move(C));
+			}
+
+		private:
+			CandidateList candidate_list;
+	};
+
+	/**
+	 * @class KernelFusionAnalysisPass
+	 * @brief A module pass to find consecutive OpenMP target regions to be fused
+	 * @details
+	 * Two target regions are candidates if they satisfy the following conditions:
+	 * - they are adjacent target regions in the same host function
+	 * - the host launches the consumer right after the producer without any side effect in between
+	 *   (checked on the CFG of the host IR given by -cgraomp-fusion-host-ir)
+	 * - each of them has exactly one valid kernel loop for the target CGRA
+	 * - the trip counts of the kernel loop nests are constant and identical
+	 * - the producer stores to an array which the consumer loads
+	 * - every consumer load of such an array reads the element stored by the producer in the same iteration,
+	 *   so that the stored value can be forwarded instead of the memory access
+	 * - the consumer does not store to arrays accessed by the producer
+	 * 
+	 * The arrays are identified by the symbol names used in the DFGs. 
+	 * Each kernel joins at most one pair.
+	 */
+	class KernelFusionAnalysisPass :
+			public AnalysisInfoMixin<KernelFusionAnalysisPass> {
+		public:
+			using Result = KernelFusionInfo;
+			Result run(Module &M, ModuleAnalysisManager &AM);
+		private:
+			friend AnalysisInfoMixin<KernelFusionAnalysisPass>;
+			static AnalysisKey Key;
+
+			/**
+			 * @brief Get the valid kernel loop of a kernel function
+			 * @tparam VerifyPassT VerifyPass type for the target CGRA category
+			 * @return Loop* the kernel loop, or nullptr if the function does not have exactly one kernel
+			 */
+			template <typename VerifyPassT>
+			Loop* getKernelLoop(Function &F, FunctionAnalysisManager &FAM);
+
+			/**
+			 * @brief check if the pair of kernels can be fused
+			 * 
+			 * @param C candidate whose functions and loops are already set. The other members are filled if it returns true.
+			 * @param FAM AnalysisManager for the functions
+			 */
+			bool isFusible(FusionCandidate &C, FunctionAnalysisManager &FAM);
+	};
+
+}
+
+#endif //KernelFusion_H
@@ -0,0 +1,166 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /include/KernelHint.hpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 05:12:07
+*    Last Modified: 17-10-2026 05:12:07
+*/
+#ifndef KernelHint_H
+#define KernelHint_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+
+#include <string>
+
+/// prefix of annotation strings generated by the macros in cgraomp.h
+#define CGRAOMP_HINT_PREFIX	"cgraomp_hint:"
+
+// Key setting of the hints
+#define HINT_II_KEY			"ii"
+#define HINT_UNROLL_KEY		"unroll"
+#define HINT_FANOUT_KEY		"max_fanout"
+#define HINT_NO_OFFLOAD_KEY	"no_offload"
+#define HINT_MODEL_KEY		"model"
+#define HINT_PIPELINE_KEY	"dfg_pipeline"
+
+using namespace llvm;
+
+namespace CGRAOmp {
+
+	/**
+	 * @struct KernelHint
+	 * @brief Tuning hints given to a kernel in the source code
+	 */
+	struct KernelHint {
+		/// target initiation interval for the mapper
+		Optional<int> ii;
+		/// unroll factor of the kernel loop
+		Optional<int> unroll;
+		/// maximum fan-out of a DFG node for the mapper
+		Optional<int> max_fanout;
+		/// the kernel is kept on the host
+		bool no_offload = false;
+		/// name of the preferred CGRA model
+		Optional<std::string> model;
+		/// DFG pass pipeline instead of -dfg-pass-pipeline
+		Optional<SmallVector<std::string>> dfg_pipeline;
+	};
+
+	/**
+	 * @class KernelHintInfo
+	 * @brief Tuning hints of each kernel
+	 */
+	class KernelHintInfo {
+		public:
+			/**
+			 * @brief Get the hints of the kernel
+			 * 
+			 * @param kernel kernel function
+			 * @return const KernelHint* nullptr if the kernel has no hint
+			 */
+			const KernelHint* getHint(Function *kernel) const {
+				auto it = hints.find(kernel);
+				return (it != hints.end()) ? &(it->second) : nullptr;
+			}
+
+			/// check if the kernel is marked not to be offloaded
+			bool isNoOffload(Function *kernel) const {
+				auto hint = getHint(kernel);
+				return hint && hint->no_offload;
+			}
+
+			void setHint(Function *kernel, const KernelHint &hint) {
+				hints[kernel] = hint;
+			}
+
+			/**
+			 * @remarks The hints are removed from the IR once they are collected.
+			 * Thus, the result is kept valid after creation.
+			 */
+			bool invalidate(Module &M, const PreservedAnalyses &PA,
+							ModuleAnalysisManager::Invalidator &Inv) {
+				return false;
+			}
+
+		private:
+			DenseMap<Function*, KernelHint> hints;
+	};
+
+	/**
+	 * @class KernelHintAnalysisPass
+	 * @brief A module analysis to collect the tuning hints of each kernel
+	 * @details The hints are calls of llvm.annotation generated by the macros in cgraomp.h.
+	 * The hints in the offloading function (i.e., the target region) apply to all the kernels in it
+	 * while the hints in the kernel function take precedence over them.
+	 */
+	class KernelHintAnalysisPass :
+			public AnalysisInfoMixin<KernelHintAnalysisPass> {
+		public:
+			using Result = KernelHintInfo;
+			Result run(Module &M, ModuleAnalysisManager &AM);
+
+			/**
+			 * @brief get the hint string if the instruction is a hint
+			 * 
+			 * @param I an instruction
+			 * @return Optional<StringRef> the hint without the prefix
+			 */
+			static Optional<StringRef> getHintString(Instruction &I);
+		private:
+			friend AnalysisInfoMixin<KernelHintAnalysisPass>;
+			static AnalysisKey Key;
+
+			/**
+			 * @brief parse the hints in the function
+			 * 
+			 * @param F a function
+			 * @param hint hints to be updated
+			 * @return true if any hint is found
+			 */
+			bool parseHints(Function &F, KernelHint &hint);
+	};
+
+	/**
+	 * @class ApplyKernelHintPass
+	 * @brief A module pass to collect the hints and remove them from the IR
+	 * @details The unroll factor is attached to the kernel loops as llvm.loop.unroll.count metadata,
+	 * which is consumed by the loop unrolling that follows this pass.
+	 * The hint is dropped if the trip count is not known to be a multiple of the factor
+	 * because the remainder loop would become another kernel.
+	 */
+	class ApplyKernelHintPass : public PassInfoMixin<ApplyKernelHintPass> {
+		public:
+			PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
+	};
+
+}
+
+#endif //KernelHint_H
@@ -0,0 +1,88 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /include/KernelVersioning.hpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 04:46:46
+*    Last Modified: 17-10-2026 04:46:46
+*/
+#ifndef KernelVersioning_H
+#define KernelVersioning_H
+
+#include "llvm/IR/PassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/InstrTypes.h"
+
+using namespace llvm;
+
+namespace CGRAOmp {
+
+	/**
+	 * @class KernelVersioningPass
+	 * @brief A module pass for host code to run kernels with small trip counts on the host
+	 * @details
+	 * Clang already emits a host fallback for each target region, which is executed when the offloading fails.
+	 * This pass inserts a runtime check of the trip count before each kernel launch (__tgt_target*)
+	 * and skips the launch if the trip count is less than the threshold given by the CGRA model.
+	 * The result of the skipped launch is regarded as a failure so that the existing check takes the fallback.
+	 * 
+	 * The trip count is derived from the bounds passed to __kmpc_for_static_init* in the outlined parallel region of the fallback.
+	 * They are re-computed at the launch site by tracing the captured variables through __kmpc_fork_call and the fallback function.
+	 * 
+	 * Kernels using data resident on the device by enclosing target data regions are not versioned
+	 * because the host fallback does not see the device copies.
+	 */
+	class KernelVersioningPass :
+			public PassInfoMixin<KernelVersioningPass> {
+		public:
+			PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
+
+		private:
+			/**
+			 * @brief insert the runtime check for a kernel launch
+			 * 
+			 * @param launch call of __tgt_target* launching a kernel
+			 * @param threshold minimum trip count to be offloaded
+			 * @param FAM AnalysisManager for the functions
+			 * @return true if the launch is versioned
+			 */
+			bool versionKernel(CallBase *launch, int threshold,
+								FunctionAnalysisManager &FAM);
+	};
+
+	/**
+	 * @class HostFallbackHintPass
+	 * @brief A module pass for host code to keep the kernels marked as "no_offload" on the host
+	 * @details The kernel launch (__tgt_target*) is removed so that the host fallback is always executed.
+	 * Kernels using resident data are still offloaded for the same reason as KernelVersioningPass.
+	 */
+	class HostFallbackHintPass :
+			public PassInfoMixin<HostFallbackHintPass> {
+		public:
+			PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
+	};
+
+}
+
+#endif //KernelVersioning_H
@@ -0,0 +1,70 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /include/LineBufferReuse.hpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 04:24:38
+*    Last Modified: 17-10-2026 04:24:38
+*/
+#ifndef LINEBUFFERREUSE_H
+#define LINEBUFFERREUSE_H
+
+#include "DFGPass.hpp"
+#include "CGRADataFlowGraph.hpp"
+
+#include "llvm/IR/PassManager.h"
+
+using namespace llvm;
+
+namespace CGRAOmp
+{
+
+	/**
+	 * @class LineBufferReuse
+	 * @brief A DFGPass to share a load stream among loads reusable via a line buffer for decoupled CGRAs
+	 * @details 
+	 * For each group found by SlidingWindowAnalysisPass, only the leader load remains as a stream.
+	 * The other loads are replaced with a chain of shift register nodes whose depths are derived from the offsets.
+	 * The AG configuration of the leader is extended so that the stream is linear, and the line buffer setting is added to the extra info.
+	 */
+	class LineBufferReuse : public PassInfoMixin<LineBufferReuse> {
+		public:
+			/**
+			 * @brief Apply the line buffer reuse for a given DFG
+			 * 
+			 * @param G Data flow graph (DFG)
+			 * @param L Loop associated with the DFGs
+			 * @param FAM FunctionAnalysisManager to access analysis results
+			 * @param LAM LoopAnalysisManager to access analysis results
+			 * @param AR LoopStandardAnalysisResults
+			 * @return It returns true if DFG G is changed
+			 * @return Otherwise, it returns false
+			 */
+			bool run(CGRADFG &G, Loop &L, FunctionAnalysisManager &FAM,
+										LoopAnalysisManager &LAM,
+										LoopStandardAnalysisResults &AR);
+	};
+}
+
+#endif //LINEBUFFERREUSE_H
@@ -162,17 +162,61 @@ namespace CGRAOmp {
 	class InductionVariableDependency : public LoopDependency {
 		public:
 			InductionVariableDependency(PHINode *indvar, Instruction *bin_op,
-				Value* start, Value *step) :
+				Value* start, Value *step, Value *bound = nullptr,
+				Instruction *exit_cond = nullptr, int nest_level = 0) :
 				LoopDependency(DepKind::InductionVar, bin_op, start, indvar, 1),
-				 step(step) {};
+				 step(step), bound(bound), exit_cond(exit_cond),
+				 nest_level(nest_level) {};
 
+			/// get the initial value of the induction variable
+			Value* getStart() {
+				return getInit();
+			}
+
+			/// get the constant step of the induction variable
+			Value* getStep() {
+				return step;
+			}
+
+			/**
+			 * @brief Get the final value compared in the loop latch
+			 * @return Value* the final value, or nullptr if it is unknown
+			 */
+			Value* getBound() {
+				return bound;
+			}
+
+			/// get the compare instruction to exit the loop (nullptr if unknown)
+			Instruction* getExitCond() {
+				return exit_cond;
+			}
+
+			/**
+			 * @brief Set the predicate comparing the bound
+			 * @param pred the loop continues while <em>(indvar + step) pred bound</em> holds
+			 */
+			void setBoundPredicate(CmpInst::Predicate pred) {
+				bound_pred = pred;
+			}
+
+			/// get the predicate comparing the bound (BAD_ICMP_PREDICATE if unknown)
+			CmpInst::Predicate getBoundPredicate() {
+				return bound_pred;
+			}
+
+			/// get the nested level relative to the kernel loop (0: outermost)
+			int getNestLevel() {
+				return nest_level;
+			}
 
 			static bool classof(const LoopDependency* LD) {
 				return LD->getKind() == LoopDependency::DepKind::InductionVar;
 			}
 		private:
-			Value *step, *start;
-			Instruction* bin_op;
+			Value *step, *bound;
+			Instruction* exit_cond;
+			int nest_level;
+			CmpInst::Predicate bound_pred = CmpInst::BAD_ICMP_PREDICATE;
 	};
 
 	/**
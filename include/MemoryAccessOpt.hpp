@@ -0,0 +1,86 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /include/MemoryAccessOpt.hpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 10:12:31
+*    Last Modified: 17-10-2026 10:12:31
+*/
+#ifndef MEMORYACCESSOPT_H
+#define MEMORYACCESSOPT_H
+
+#include "DFGPass.hpp"
+#include "CGRADataFlowGraph.hpp"
+
+#include "llvm/IR/PassManager.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Instruction.h"
+
+using namespace llvm;
+
+namespace CGRAOmp
+{
+
+	/**
+	 * @class MemoryAccessOpt
+	 * @brief A DFGPass to reduce memory accesses in an iteration for time-multiplexed CGRAs
+	 * @details 
+	 * It applies the following optimizations:
+	 * -# store-to-load forwarding: a load reading the address just stored in the same iteration is replaced with the stored value
+	 * -# redundant load elimination: loads of the same address are merged into the first one
+	 *
+	 * Two accesses are regarded as the same address if their pointers have the same SCEV.
+	 * Any instruction which may write the address between the two accesses prevents the optimization (see Utils::isAccessedBetween).
+	 */
+	class MemoryAccessOpt : public PassInfoMixin<MemoryAccessOpt> {
+		public:
+			/**
+			 * @brief Apply the memory access optimization for a given DFG
+			 * 
+			 * @param G Data flow graph (DFG)
+			 * @param L Loop associated with the DFGs
+			 * @param FAM FunctionAnalysisManager to access analysis results
+			 * @param LAM LoopAnalysisManager to access analysis results
+			 * @param AR LoopStandardAnalysisResults
+			 * @return It returns true if DFG G is changed
+			 * @return Otherwise, it returns false
+			 */
+			bool run(CGRADFG &G, Loop &L, FunctionAnalysisManager &FAM,
+										LoopAnalysisManager &LAM,
+										LoopStandardAnalysisResults &AR);
+		private:
+			/**
+			 * @brief check if two memory accesses refer the same address
+			 * 
+			 * @param A load or store instruction
+			 * @param B load or store instruction
+			 * @param SE ScalarEvolution
+			 * @return true if the addresses are the same
+			 */
+			bool isSameAddress(Instruction *A, Instruction *B,
+								ScalarEvolution &SE);
+	};
+}
+
+#endif //MEMORYACCESSOPT_H
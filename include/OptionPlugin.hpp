@@ -159,7 +159,7 @@ namespace CGRAOmp
 	};
 
 	/// path to model config
-	extern cl::opt<string> PathToCGRAConfig;
+	extern cl::list<string> PathToCGRAConfig;
 	/// alias of config file path
 	extern cl::alias PathToCGRAConfigAlias;
 
@@ -201,6 +201,21 @@ namespace CGRAOmp
 	/// to enable loop-flatten pass for CGRA kernel
 	extern cl::opt<bool> OptEnableLoopFlatten;
 
+	/// path to the data transfer plan report
+	extern cl::opt<string> OptTransferPlanFile;
+
+	/// path to the manifest of generated DFGs
+	extern cl::opt<string> OptDFGManifestFile;
+
+	/// to fuse DFGs of consecutive target regions
+	extern cl::opt<bool> OptFuseKernels;
+
+	/// path to the host IR to check the launches of the fused kernels
+	extern cl::opt<string> OptFusionHostIR;
+
+	/// path to the summary table of multiple models
+	extern cl::opt<string> OptDSESummaryFile;
+
 
 
 }
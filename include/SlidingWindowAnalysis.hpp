@@ -0,0 +1,213 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /include/SlidingWindowAnalysis.hpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 04:23:37
+*    Last Modified: 17-10-2026 04:23:37
+*/
+#ifndef SlidingWindowAnalysis_H
+#define SlidingWindowAnalysis_H
+
+#include "llvm/IR/PassManager.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/LoopAnalysisManager.h"
+#include "llvm/ADT/iterator_range.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include "AGVerifyPass.hpp"
+
+#include <utility>
+
+using namespace llvm;
+
+namespace CGRAOmp {
+
+	/**
+	 * @class ReuseGroup
+	 * @brief A group of loads whose data can be shared via a line buffer
+	 * @details All the loads in a group have the same base and the same steps and counts for each dimension.
+	 * They differ only in constant offsets. Thus, only the leader load is issued as a stream and the others are obtained by delaying it.
+	 */
+	class ReuseGroup {
+		public:
+			using ConfigTy = AffineAGCompatibility::ConfigTy;
+			using TapTy = std::pair<LoadInst*, int>;
+
+			ReuseGroup(LoadInst *leader, ConfigTy stream) :
+				leader(leader), stream(stream) {};
+
+			/// get the load issued as a stream
+			LoadInst* getLeader() const {
+				return leader;
+			}
+
+			/// get the AG configuration of the stream extended for the line buffer
+			const ConfigTy& getStreamConfig() const {
+				return stream;
+			}
+
+			/// set the AG configuration of the stream
+			void setStreamConfig(ConfigTy C) {
+				stream = C;
+			}
+
+			/**
+			 * @brief add a load obtained from the line buffer
+			 * 
+			 * @param load the load to be replaced
+			 * @param delay the number of iterations to be delayed from the leader
+			 */
+			void addTap(LoadInst *load, int delay) {
+				taps.emplace_back(load, delay);
+			}
+
+			/// get the list of the loads and their delays
+			ArrayRef<TapTy> getTaps() const {
+				return taps;
+			}
+
+			/// get the depth of the line buffer, i.e., the longest delay
+			int getDepth() const {
+				int depth = 0;
+				for (auto tap : taps) {
+					depth = std::max(depth, tap.second);
+				}
+				return depth;
+			}
+
+			/// set the number of extra iterations per innermost loop to fill the buffer
+			void setRowExtension(int ext) {
+				row_extension = ext;
+			}
+
+			/// get the number of extra iterations per innermost loop to fill the buffer
+			int getRowExtension() const {
+				return row_extension;
+			}
+
+			/**
+			 * @brief set the number of elements streamed before the first row
+			 * @remarks the outputs of these iterations are dropped
+			 */
+			void setWarmup(int elems) {
+				warmup = elems;
+			}
+
+			/// get the number of elements streamed before the first row
+			int getWarmup() const {
+				return warmup;
+			}
+
+		private:
+			LoadInst *leader;
+			ConfigTy stream;
+			SmallVector<TapTy> taps;
+			int row_extension = 0;
+			int warmup = 0;
+	};
+
+	/**
+	 * @class SlidingWindowInfo
+	 * @brief SlidingWindowAnalysis result
+	 */
+	class SlidingWindowInfo {
+		public:
+			using GroupList = SmallVector<ReuseGroup>;
+			using group_iterator = GroupList::iterator;
+
+			inline group_iterator group_begin() {
+				return group_list.begin();
+			}
+			inline group_iterator group_end() {
+				return group_list.end();
+			}
+			inline iterator_range<group_iterator> groups() {
+				return make_range(group_begin(), group_end());
+			}
+
+			void add_group(ReuseGroup G) {
+				group_list.emplace_back(std::move(G));
+			}
+
+			int getNumGroups() {
+				return group_list.size();
+			}
+
+		private:
+			GroupList group_list;
+	};
+
+	/**
+	 * @class SlidingWindowAnalysisPass
+	 * @brief A loop pass to find loads reusable via line buffers for affine AGs
+	 * @details
+	 * A group is made if the address streams are linear over the flattened iteration space
+	 * after extending the innermost loop to the stride of the outer loop.
+	 * For example, a 3x3 stencil over a @f$ W @f$ width image becomes a stream with nine taps whose delays are
+	 * @f$ 0, 1, 2, W, W+1, W+2, 2W, 2W+1, 2W+2 @f$.
+	 * The row extension (2 for this example) does not cover the delays over rows,
+	 * so the stream starts @f$ 2W @f$ elements earlier (warm-up) and the outputs of those iterations are dropped.
+	 */
+	class SlidingWindowAnalysisPass :
+			public AnalysisInfoMixin<SlidingWindowAnalysisPass> {
+		public:
+			using Result = SlidingWindowInfo;
+			Result run(Loop &L, LoopAnalysisManager &AM,
+								LoopStandardAnalysisResults &AR);
+		private:
+			friend AnalysisInfoMixin<SlidingWindowAnalysisPass>;
+			static AnalysisKey Key;
+
+			using ConfigTy = AffineAGCompatibility::ConfigTy;
+
+			/**
+			 * @brief check if two configurations differ only in constant offsets
+			 */
+			bool isSameShape(const ConfigTy &A, const ConfigTy &B);
+
+			/**
+			 * @brief get the total offset of a configuration
+			 */
+			int64_t getOffset(const ConfigTy &C);
+
+			/**
+			 * @brief extend the innermost loop so that the stream is linear
+			 * 
+			 * @param C configuration to be extended
+			 * @return Optional<int> the number of the extended iterations if possible
+			 */
+			Optional<int> linearize(ConfigTy &C);
+
+			/**
+			 * @brief start a linear stream earlier to fill the line buffer
+			 * 
+			 * @param C linearized configuration to be modified
+			 * @param elems the number of elements to be streamed in advance
+			 */
+			void prefill(ConfigTy &C, int elems);
+	};
+}
+
+#endif //SlidingWindowAnalysis_H
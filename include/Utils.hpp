@@ -37,6 +37,8 @@
 #include "llvm/Analysis/LoopAnalysisManager.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Analysis/MemoryLocation.h"
 
 #include <string>
 
@@ -69,6 +71,40 @@ namespace CGRAOmp {
 		std::string getFloatType(const APFloat f);
 
 		double getFloatValueAsDouble(const APFloat f);
+
+		/**
+		 * @brief check if a memory location may be accessed by instructions executed between two instructions in the loop
+		 * @details Instructions which are not executed between @em From and @em To in terms of dominance are ignored.
+		 * Others are checked with alias analysis.
+		 * 
+		 * @param From an instruction executed first
+		 * @param To an instruction executed later
+		 * @param Loc the memory location to be checked
+		 * @param L Loop including the instructions
+		 * @param AR LoopStandardAnalysisResults
+		 * @param check_read if true, reading the location is also regarded as an access
+		 * @param ignore instructions to be ignored
+		 * @return true if any instruction between them may write (or read) the location
+		 */
+		bool isAccessedBetween(Instruction *From, Instruction *To,
+							const MemoryLocation &Loc, Loop &L,
+							LoopStandardAnalysisResults &AR,
+							bool check_read = false,
+							ArrayRef<Instruction*> ignore = {});
+
+		/**
+		 * @brief estimate the dynamic weight of a loop
+		 * @details The weight is the number of iterations multiplied by the number of instructions in the loop body
+		 * so that profiled and unprofiled kernels are compared in the same unit.
+		 * If the function has profile data, the number of iterations is the absolute execution count of the loop header.
+		 * Otherwise, it is a heuristic static estimate: the product of the trip counts of the loop and its parent loops
+		 * (100 is assumed for unknown trip counts).
+		 * 
+		 * @param L Loop
+		 * @param AR LoopStandardAnalysisResults
+		 * @return double the weight
+		 */
+		double getLoopWeight(Loop &L, LoopStandardAnalysisResults &AR);
 		
 	}
 
@@ -70,6 +70,8 @@ namespace CGRAOmp {
 		Decoupling,
 		/// Checking the instructions needed in the kernel are supported or not
 		InstAvailability,
+		/// Checking the operations of the kernel fit the PE classes
+		PEDemand,
 		/// Checking the kernel exceeds the maximumn nested level
 		MaxNestedLevel,
 		/// Checking each memory access meets the allowed access pattern
@@ -280,6 +282,28 @@ namespace CGRAOmp {
 				loop_verify_results[L] = LVR;
 			}
 
+			/// a rejected loop and the names of the violated rules
+			using RejectedKernel = std::pair<Loop*, SmallVector<std::string>>;
+
+			/**
+			 * @brief register a loop kernel rejected by the verification
+			 * @param L Loop
+			 * @param LVR the verification result of the loop
+			 */
+			void registerRejectedKernel(Loop *L, LoopVerifyResult &LVR) {
+				SmallVector<std::string> violations;
+				for (auto item : LVR.results()) {
+					if (!*item.second) {
+						violations.push_back(item.second->getName().str());
+					}
+				}
+				rejected_kernels.emplace_back(L, std::move(violations));
+			}
+
+			inline ArrayRef<RejectedKernel> rejected() const {
+				return rejected_kernels;
+			}
+
 			inline kernel_iterator kernel_begin() {
 				return valid_kernels.begin();
 			};
@@ -313,6 +337,7 @@ namespace CGRAOmp {
 
 		private:
 			std::map<Loop*, LoopVerifyResult> loop_verify_results;
+			SmallVector<RejectedKernel> rejected_kernels;
 	};
 
 	/**
@@ -345,6 +370,7 @@ namespace CGRAOmp {
 
 	using DecoupleAnalysisResult = SimpleVerifyResult<VerificationKind::Decoupling>;
 	using InterLoopDependencyAnalysisResult = SimpleVerifyResult<VerificationKind::InterLoopDep>;
+	using PEDemandResult = SimpleVerifyResult<VerificationKind::PEDemand>;
 
 	/**
 	 * @class VerifyPassBase
@@ -372,6 +398,29 @@ namespace CGRAOmp {
 
 			void remarkEmitter(Function &F, Loop &L, LoopVerifyResult &R,
 										 FunctionAnalysisManager &AM);
+
+			/**
+			 * @brief check if the kernel is excluded by its hints
+			 * @details A kernel is excluded if it is marked as "no_offload"
+			 * or another model is preferred for it.
+			 * 
+			 * @param F kernel function
+			 * @param AM FunctionAnalysisManager
+			 * @return true if the kernel must not be verified for the current model
+			 */
+			bool isExcludedByHint(Function &F, FunctionAnalysisManager &AM);
+
+			/**
+			 * @brief verify the operations of the kernel fit the PE classes of the model
+			 * 
+			 * @param model CGRA model
+			 * @param IM instruction mapping of the function
+			 * @param insts instructions to be executed on the PEs
+			 * 	- unsupported instructions are ignored
+			 * @return PEDemandResult* the result, which is violated if they do not fit
+			 */
+			PEDemandResult* verifyPEDemand(CGRAModel *model, InstMapInfo &IM,
+											ArrayRef<Instruction*> insts);
 		};
 
 	/**
@@ -477,6 +526,20 @@ namespace CGRAOmp {
 			static AnalysisKey Key;
 			using InstList = SmallVector<Instruction*>;
 
+			/**
+			 * @brief Get the cached instruction mapping of the function containing the loop
+			 * @remark InstMapAnalysisPass must be executed by the function-level verification in advance
+			 */
+			static InstMapInfo& getInstMapInfo(Loop &L, LoopAnalysisManager &AM,
+										LoopStandardAnalysisResults &AR)
+			{
+				auto &FAMProxy = AM.getResult<FunctionAnalysisManagerLoopProxy>(L, AR);
+				auto *F = L.getHeader()->getParent();
+				auto *IM = FAMProxy.getCachedResult<InstMapAnalysisPass>(*F);
+				assert(IM && "InstMapAnalysisPass must be executed before this pass");
+				return *IM;
+			}
+
 			/**
 			 * @brief default routine to check whether the kernel contains unspported instructions
 			 * 
@@ -494,15 +557,13 @@ namespace CGRAOmp {
 				auto LN = LoopNest::getLoopNest(L, AR.SE);
 				auto innermost = LN->getInnermostLoop();
 
-				auto &MM = AM.getResult<ModelManagerLoopProxy>(L, AR);
-				auto *model = MM.getModel();
+				auto &IM = getInstMapInfo(L, AM, AR);
 
 				InstList unsupported;
 
 				for (auto &BB : innermost->getBlocks()) {
 					for (auto &I : *BB) {
-						auto *imap = model->isSupported(&I);
-						if (!imap) {
+						if (!IM.isSupported(&I)) {
 							unsupported.emplace_back(&I);
 						}
 					}
@@ -533,6 +594,14 @@ namespace CGRAOmp {
 								FunctionAnalysisManager &AM);
 	};
 
+	/**
+	 * @brief register the analyses for kernel verification to the pass builder
+	 * @remarks It is used as the plugin entry and by tools linking CGRAOmp statically
+	 *
+	 * @param PB PassBuilder
+	 */
+	void registerVerifyPasses(PassBuilder &PB);
+
 }
 
 #endif //VerifyPass_H
\ No newline at end of file
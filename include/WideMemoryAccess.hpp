@@ -0,0 +1,135 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /include/WideMemoryAccess.hpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 04:29:06
+*    Last Modified: 17-10-2026 04:29:06
+*/
+#ifndef WIDEMEMORYACCESS_H
+#define WIDEMEMORYACCESS_H
+
+#include "DFGPass.hpp"
+#include "CGRADataFlowGraph.hpp"
+
+#include "llvm/IR/PassManager.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Support/JSON.h"
+
+using namespace llvm;
+
+namespace CGRAOmp
+{
+
+	/**
+	 * @class WideMemoryAccess
+	 * @brief A DFGPass to merge memory accesses to adjacent addresses into wide accesses
+	 * @details 
+	 * Loads (or stores) of the same data type in a basic block are grouped if the differences of their addresses are constant.
+	 * Each run of consecutive elements is replaced with a WideMemAccessNode as long as the total width does not exceed the width specified by the CGRA model.
+	 * The lanes of a wide load are given by extract nodes, and the data of a wide store is packed by a chain of insert nodes.
+	 *
+	 * The merging is prevented if any other instruction between the accesses may write (or read, in case of stores) the addresses (see Utils::isAccessedBetween).
+	 * The alignment of the wide accesses is not taken into account.
+	 *
+	 * For decoupled CGRAs, the AG config of a wide access has the lanes and their width in addition to the stream of the leader.
+	 * Accesses are not merged unless all the lanes follow the same affine stream.
+	 */
+	class WideMemoryAccess : public PassInfoMixin<WideMemoryAccess> {
+		public:
+			/**
+			 * @brief Apply the wide memory access merging for a given DFG
+			 * 
+			 * @param G Data flow graph (DFG)
+			 * @param L Loop associated with the DFGs
+			 * @param FAM FunctionAnalysisManager to access analysis results
+			 * @param LAM LoopAnalysisManager to access analysis results
+			 * @param AR LoopStandardAnalysisResults
+			 * @return It returns true if DFG G is changed
+			 * @return Otherwise, it returns false
+			 */
+			bool run(CGRADFG &G, Loop &L, FunctionAnalysisManager &FAM,
+										LoopAnalysisManager &LAM,
+										LoopStandardAnalysisResults &AR);
+		private:
+			/// a memory access node and its element offset from the group leader
+			using LaneTy = std::pair<DFGNode*, int64_t>;
+
+			/**
+			 * @brief group memory access nodes with constant address differences
+			 * 
+			 * @param accesses list of load or store nodes
+			 * @param SE ScalarEvolution
+			 * @param groups the result. Each group is sorted by the offset.
+			 */
+			void groupAdjacent(ArrayRef<DFGNode*> accesses, ScalarEvolution &SE,
+								SmallVectorImpl<SmallVector<LaneTy>> &groups);
+
+			/**
+			 * @brief check if accesses in a run can be merged safely
+			 * 
+			 * @param run list of the accesses
+			 * @param G Data flow graph (DFG)
+			 * @param L Loop associated with the DFGs
+			 * @param AR LoopStandardAnalysisResults
+			 * @return true if it can be merged
+			 */
+			bool isMergeable(ArrayRef<LaneTy> run, CGRADFG &G, Loop &L,
+								LoopStandardAnalysisResults &AR);
+
+			/**
+			 * @brief make the AG config of a wide access for decoupled CGRAs
+			 * 
+			 * @param run list of the accesses
+			 * @param lane_width data width of each lane
+			 * @param AR LoopStandardAnalysisResults
+			 * @return the config, or None if the lanes are not a single affine stream
+			 */
+			Optional<json::Value> getWideAGConfig(ArrayRef<LaneTy> run, int lane_width,
+								LoopStandardAnalysisResults &AR);
+
+			/**
+			 * @brief replace loads in a run with a wide load and extract nodes
+			 */
+			void mergeLoads(ArrayRef<LaneTy> run, CGRADFG &G, int lane_width,
+								Optional<json::Value> &ag_config);
+
+			/**
+			 * @brief replace stores in a run with a wide store and insert nodes
+			 */
+			void mergeStores(ArrayRef<LaneTy> run, CGRADFG &G, int lane_width,
+								Optional<json::Value> &ag_config);
+
+			/**
+			 * @brief create a wide access node inheriting the address of the leader
+			 * @param ag_config AG config of the wide access (None to inherit that of the leader)
+			 */
+			DFGNode* createWideNode(DFGNode *Leader, int lanes, int lane_width,
+										CGRADFG &G, Optional<json::Value> &ag_config);
+	};
+}
+
+#endif //WIDEMEMORYACCESS_H
@@ -34,4 +34,29 @@
 #define CGRAOMP_CUSTOM_INST __attribute__((annotate("cgra_custom_inst")))                                         
 #else
 #define CGRAOMP_CUSTOM_INST __attribute__((always_inline))                                                        
-#endif
\ No newline at end of file
+#endif
+
+/*
+ * Kernel tuning hints
+ * Put them at the beginning of a target region (or of the loop body of a kernel), e.g.,
+ *   #pragma omp target parallel for
+ *   for (int i = 0; i < N; i++) {
+ *     CGRAOMP_TARGET_II(2);
+ *     ...
+ *   }
+ * The hints in a target region apply to all the kernels in it.
+ * Numbers must be given as literals because they are stringified.
+ */
+#define CGRAOMP_HINT(hint) ((void)__builtin_annotation(0, "cgraomp_hint:" hint))
+/* target initiation interval for the mapper */
+#define CGRAOMP_TARGET_II(n) CGRAOMP_HINT("ii=" #n)
+/* unroll factor of the kernel loop (ignored unless the trip count is a multiple of it) */
+#define CGRAOMP_UNROLL(n) CGRAOMP_HINT("unroll=" #n)
+/* maximum fan-out of a DFG node for the mapper */
+#define CGRAOMP_MAX_FANOUT(n) CGRAOMP_HINT("max_fanout=" #n)
+/* keep the kernel on the host (the host fallback is always executed) */
+#define CGRAOMP_NO_OFFLOAD CGRAOMP_HINT("no_offload")
+/* extract the kernel only for the model (name of the config file without extension) */
+#define CGRAOMP_PREFER_MODEL(name) CGRAOMP_HINT("model=" name)
+/* comma separated DFG pass pipeline instead of -dfg-pass-pipeline */
+#define CGRAOMP_DFG_PIPELINE(pipeline) CGRAOMP_HINT("dfg_pipeline=" pipeline)
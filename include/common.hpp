@@ -32,6 +32,10 @@
 #define CGRA_OMP_COMMON_H
 
 #define CGRAOMP_PASS_NAME "cgraomp"
+#define CGRAOMP_PREOPT_PASS_NAME "cgraomp-preopt"
+#define CGRAOMP_TRANSFER_PASS_NAME "cgraomp-transfer-plan"
+#define CGRAOMP_VERSIONING_PASS_NAME "cgraomp-kernel-versioning"
+#define CGRAOMP_HOST_HINT_PASS_NAME "cgraomp-host-hint"
 
 #define ERR_MSG_PREFIX "CGRAOmpPass \x1B[31m\033[1mError\033[0m: "
 #define WARN_MSG_PREFIX "\x1B[35m\033[1mWarning\033[0m: "
@@ -65,10 +65,15 @@ cursor_up_finder = re.compile(r'\x1B\[A')
 
 from .decorder import decode
 
-def backend_wrapper(files, cmd, panel_num, proc_num, nowait, no_rich):
+def backend_wrapper(kernels, cmd, panel_num, proc_num, nowait, no_rich):
+    """run the backend for each kernel listed in the DFG manifests
+    in the given order (hotter kernels should be listed first)"""
+    total = sum([k.get("weight", 0.0) for k in kernels])
     jobs = []
-    for f in files:
-        jobs.append(BackendJob(f, cmd))
+    for k in kernels:
+        weight = k.get("weight", 0.0)
+        ratio = weight / total if total > 0 else 1.0 / len(kernels)
+        jobs.append(BackendJob(k["dfg"], cmd, weight, ratio, k))
     if rich_available and not no_rich:
         runner = RichRunner(panel_num, jobs, proc_num, nowait)
     else:
@@ -91,8 +96,13 @@ class Header:
 
 class BackendJob():
 
-    def __init__(self, dotfile : str, cmd : List[str]):
+    def __init__(self, dotfile : str, cmd : List[str], weight : float = 0.0,
+                    weight_ratio : float = 1.0, kernel : Dict = None):
         self.dotfile = dotfile
+        self.weight = weight
+        self.weight_ratio = weight_ratio
+        # manifest entry of the kernel
+        self.kernel = kernel if kernel is not None else dict()
         self.buf = bytes()
         self.proc : subprocess.Popen = None
         self.finished = False
@@ -125,6 +135,18 @@ class BackendJob():
         env["COLUMNS"] = str(self.col_size - 4)
         env["LINES"] = str(self.row_size - 4)
         env["DOTFILE_NAME"] = self.dotfile
+        # hotness of the kernel to budget the mapping effort
+        env["KERNEL_WEIGHT"] = str(self.weight)
+        env["KERNEL_WEIGHT_RATIO"] = str(self.weight_ratio)
+        # other information from the DFG manifest
+        if "kernel" in self.kernel:
+            env["KERNEL_NAME"] = self.kernel["kernel"]
+        if "extra" in self.kernel:
+            env["EXTRA_INFO_NAME"] = self.kernel["extra"]
+        if "nodes" in self.kernel:
+            env["DFG_NUM_NODES"] = str(self.kernel["nodes"])
+        if "edges" in self.kernel:
+            env["DFG_NUM_EDGES"] = str(self.kernel["edges"])
         # launch a process
         self.proc = subprocess.Popen(self.cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, env = env)
         # making the stdout non-blocking mode
@@ -52,9 +52,9 @@ CLANG_O2_FLAGS.append(["-targetlibinfo", "-tti", "-tbaa", "-scoped-noalias-aa",
 
 # default setting for pre optimization when -O0 is specified
 # in this case, only loop canonicalization will be applied
-PRE_OPTS_O0 = [["-polly-canonicalize"]]
+PRE_OPTS_O0 = "cgraomp-preopt<O0>"
 
 # default setting for pre optimization when -O1 or higher level is specified
-PRE_OPTS = []
-PRE_OPTS.append(["--inferattrs", "--indvars", "--indvars-widen-indvars", "--aa-pipeline=\"basic-aa,scoped-noalias-aa,tbaa,globals-aa,scev-aa\"", "-loop-unroll", "--unroll-allow-partial", "-simplifycfg", "-loop-simplify", "-loop-idiom", "-loop-instsimplify", "-loop-rotate", "-mem2reg", "-instcombine", "-loop-load-elim", "-instsimplify", "--early-cse", "--early-cse-memssa", "-dce",  "--scalar-evolution", "-memoryssa", "-gvn", "-constmerge", "-simplifycfg", "-reassociate", "-instcombine", "-mldst-motion", "-polly-canonicalize"])
-
+# the pipeline is registered by the CGRAOmp pass plugin and shares the analyses
+# with the following cgraomp pipeline
+PRE_OPTS = "cgraomp-preopt<O2>"
@@ -33,6 +33,7 @@
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Instruction.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Module.h"
 
 #include "common.hpp"
@@ -46,22 +47,38 @@ using namespace std;
 
 
 /* =================== Implementation of MapCondition =================== */
-bool MapCondition::match(Instruction *I)
+/**
+ * @details The condition is compiled into a flat form when it is parsed.
+ * Flags are tested against a single word extracted from the instruction,
+ * and a constant operand is checked according to its tagged kind.
+*/
+bool MapCondition::match(Instruction *I) const
 {
-	if (flag_list.size() > 0) {
-		for (auto flag : flag_list) {
-			if (!(FlagGetter[flag])(I)) {
+	if (flag_mask != 0) {
+		if ((getFlagWord(I) & flag_mask) != flag_mask) {
+			return false;
+		}
+	}
+	switch (const_kind) {
+		case ConstKind::Int:
+		{
+			if (const_operand >= I->getNumOperands()) return false;
+			auto cint = dyn_cast<ConstantInt>(I->getOperand(const_operand));
+			if (!cint || cint->getSExtValue() != use_int) return false;
+			break;
+		}
+		case ConstKind::Double:
+		{
+			if (const_operand >= I->getNumOperands()) return false;
+			auto cfp = dyn_cast<ConstantFP>(I->getOperand(const_operand));
+			if (!cfp || !equal_double(use_double,
+							cfp->getValueAPF().convertToDouble())) {
 				return false;
 			}
+			break;
 		}
-	}
-	if (!anyLHS) {
-		bool match = match_use(I);
-		if (!match) return false;
-	}
-	if (!anyRHS) {
-		bool match = match_use(I);
-		if (!match) return false;
+		default:
+			break;
 	}
 	if (!anyPred) {
 		if (auto cmp_inst = dyn_cast<CmpInst>(I)) {
@@ -73,18 +90,39 @@ bool MapCondition::match(Instruction *I)
 	return true;
 }
 
-StringMap<std::function<bool(Instruction*)>> MapCondition::FlagGetter({
-	FLAG_GETTER("nuw", OverflowingBinaryOperator, hasNoUnsignedWrap),
-	FLAG_GETTER("nsw", OverflowingBinaryOperator, hasNoSignedWrap),
-	FLAG_GETTER("exact", PossiblyExactOperator, isExact),
-	FLAG_GETTER("fast", FPMathOperator, isFast),
-	FLAG_GETTER("nnan", FPMathOperator, hasNoNaNs),
-	FLAG_GETTER("ninf", FPMathOperator, hasNoInfs),
-	FLAG_GETTER("nsz", FPMathOperator, hasNoSignedZeros),
-	FLAG_GETTER("arcp", FPMathOperator, hasAllowReciprocal),
-	FLAG_GETTER("contract", FPMathOperator, hasAllowContract),
-	FLAG_GETTER("afn", FPMathOperator, hasApproxFunc),
-	FLAG_GETTER("reassoc", FPMathOperator, hasAllowReassoc),
+uint32_t MapCondition::getFlagWord(Instruction *I)
+{
+	uint32_t word = 0;
+	if (auto OBO = dyn_cast<OverflowingBinaryOperator>(I)) {
+		if (OBO->hasNoUnsignedWrap()) word |= NUW;
+		if (OBO->hasNoSignedWrap()) word |= NSW;
+	} else if (auto PEO = dyn_cast<PossiblyExactOperator>(I)) {
+		if (PEO->isExact()) word |= EXACT;
+	} else if (auto FPO = dyn_cast<FPMathOperator>(I)) {
+		auto FMF = FPO->getFastMathFlags();
+		if (FMF.noNaNs()) word |= NNAN;
+		if (FMF.noInfs()) word |= NINF;
+		if (FMF.noSignedZeros()) word |= NSZ;
+		if (FMF.allowReciprocal()) word |= ARCP;
+		if (FMF.allowContract()) word |= CONTRACT;
+		if (FMF.approxFunc()) word |= AFN;
+		if (FMF.allowReassoc()) word |= REASSOC;
+	}
+	return word;
+}
+
+StringMap<MapCondition::FlagBit> MapCondition::FlagMap({
+	FLAG_BIT_PAIR("nuw", NUW),
+	FLAG_BIT_PAIR("nsw", NSW),
+	FLAG_BIT_PAIR("exact", EXACT),
+	FLAG_BIT_PAIR("fast", FAST),
+	FLAG_BIT_PAIR("nnan", NNAN),
+	FLAG_BIT_PAIR("ninf", NINF),
+	FLAG_BIT_PAIR("nsz", NSZ),
+	FLAG_BIT_PAIR("arcp", ARCP),
+	FLAG_BIT_PAIR("contract", CONTRACT),
+	FLAG_BIT_PAIR("afn", AFN),
+	FLAG_BIT_PAIR("reassoc", REASSOC),
 });
 
 StringMap<CmpInst::Predicate> MapCondition::PredMap({
@@ -108,9 +146,10 @@ StringMap<CmpInst::Predicate> MapCondition::PredMap({
 
 Error MapCondition::setFlags(ArrayRef<string> flags){
 	for (auto f : flags) {
-		auto it = FlagGetter.find(f);
-		if (it != FlagGetter.end()) {
+		auto it = FlagMap.find(f);
+		if (it != FlagMap.end()) {
 			flag_list.push_back(it->first());
+			flag_mask |= it->second;
 		} else {
 			// invalid flag string
 			error_code EC;
@@ -144,14 +183,13 @@ void MapCondition::print(raw_ostream &OS)
 	if (flag_list.size() > 0) {
 		OS << formatv("\tflags: {0}\n", VEC_MAKE_RANGE(flag_list));
 	}
-	if (!anyLHS) {
-		OS << "\tLHS operand: ";
-	}
-	if (!anyRHS) {
-		OS << "\tRHS operand: ";
-	}
-	if (!anyLHS || !anyRHS) {
-		if (isUseInt) {
+	if (const_kind != ConstKind::Any) {
+		if (const_operand == 0) {
+			OS << "\tLHS operand: ";
+		} else {
+			OS << "\tRHS operand: ";
+		}
+		if (const_kind == ConstKind::Int) {
 			OS << formatv("\tConst Int {0}\n", use_int);
 		} else {
 			OS << formatv("\tConst double {0}\n ", use_double);
@@ -166,39 +204,17 @@ void MapCondition::print(raw_ostream &OS)
 }
 
 void MapCondition::setConst(int use, bool isLeft) {
-	assert(anyLHS && anyRHS && "Only once either setConst or setRHS can be used");
-	const_operand = 0 ? isLeft : 1;
+	assert(const_kind == ConstKind::Any && "Only once either setConst or setRHS can be used");
+	const_kind = ConstKind::Int;
+	const_operand = isLeft ? 0 : 1;
 	use_int = use;
-	if (isLeft) anyLHS = false;
-	else anyRHS = false;
-	isUseInt = true;
-	match_use = [=](Instruction *I) {
-					if (const_operand < I->getNumOperands()) {
-						auto V = I->getOperand(const_operand);
-						if (auto cint = dyn_cast<ConstantInt>(V)) {
-							return use_int == cint->getSExtValue();
-						}
-					}
-					return false;
-				};
 };
 
 void MapCondition::setConst(double use, bool isLeft) {
-	assert(anyLHS && anyRHS && "Only once either setLHS or setRHS can be used");
-	const_operand = 0 ? isLeft : 1;
+	assert(const_kind == ConstKind::Any && "Only once either setLHS or setRHS can be used");
+	const_kind = ConstKind::Double;
+	const_operand = isLeft ? 0 : 1;
 	use_double = use;
-	if (isLeft) anyLHS = false;
-	else anyRHS = false;
-	match_use = [=](Instruction *I) {
-					if (const_operand < I->getNumOperands()) {
-						auto V = I->getOperand(const_operand);
-						if (auto cfp = dyn_cast<ConstantFP>(V)) {
-							return equal_double(use_double,
-										cfp->getValue().convertToDouble());
-						}
-					}
-					return false;
-				};
 }
 
 /* =================== Implementation of InstMap =================== */
@@ -218,6 +234,7 @@ Error InstMap::add_generic_inst(StringRef opcode)
 		entry_ptr x = (generator->second)(nullptr);
 		entries.push_back(x);
 		defaultEntries[opcode] = x;
+		index_valid = false;
 	} else {
 		// not supported
 		error_code EC;
@@ -227,7 +244,7 @@ Error InstMap::add_generic_inst(StringRef opcode)
 	return ErrorSuccess();
 }
 
-void InstMap::add_custom_inst(StringRef opcode, ModuleAnalysisManager &MAM)
+void InstMap::add_custom_inst(StringRef opcode)
 {
 	if (defaultEntries.find(opcode) != defaultEntries.end()) {
 		// already added
@@ -237,16 +254,17 @@ void InstMap::add_custom_inst(StringRef opcode, ModuleAnalysisManager &MAM)
 		}
 	} else {
 		auto opcode_str = opcode.str();
-		entry_gen[opcode] = [&,opcode_str](MapCondition *c){
+		entry_gen[opcode] = [opcode_str](MapCondition *c){
 			if (c) {
-				return make_shared<CustomInstMapEntry>(opcode_str, MAM, c);
+				return make_shared<CustomInstMapEntry>(opcode_str, c);
 			} else {
-				return make_shared<CustomInstMapEntry>(opcode_str, MAM);
+				return make_shared<CustomInstMapEntry>(opcode_str);
 			}
 		};
 		entry_ptr x = entry_gen[opcode](nullptr);
 		entries.push_back(x);
 		defaultEntries[opcode] = x;
+		index_valid = false;
 	}
 }
 
@@ -279,6 +297,7 @@ Error InstMap::add_map_entry(StringRef opcode, MapCondition* map_cond)
 			// just add new entry
 			entries.push_back((entry_gen[opcode])(map_cond));
 		}
+		index_valid = false;
 	}
 
 	return ErrorSuccess();
@@ -296,11 +315,29 @@ StringMap<InstMap::entry_generator> InstMap::entry_gen({
 	BINOP_ENTRY("shl", Shl), BINOP_ENTRY("lshr", LShr),
 	BINOP_ENTRY("ashr", AShr), BINOP_ENTRY("and", And),
 	BINOP_ENTRY("or", Or), BINOP_ENTRY("xor", Xor),
+	UNARYOP_ENTRY("fneg", FNeg),
 	COMPOP_ENTRY("icmp", true), COMPOP_ENTRY("fcmp", false),
 	MEMOP_ENTRY("load", Load), MEMOP_ENTRY("store", Store),
 	OTHEROP_ENTRY("select", Instruction::OtherOps::Select),
 	OTHEROP_ENTRY("bitcast", Instruction::CastOps::BitCast),
 	OTHEROP_ENTRY("zext", Instruction::CastOps::ZExt),
+	OTHEROP_ENTRY("sext", Instruction::CastOps::SExt),
+	OTHEROP_ENTRY("trunc", Instruction::CastOps::Trunc),
+	OTHEROP_ENTRY("fptrunc", Instruction::CastOps::FPTrunc),
+	OTHEROP_ENTRY("fpext", Instruction::CastOps::FPExt),
+	OTHEROP_ENTRY("fptoui", Instruction::CastOps::FPToUI),
+	OTHEROP_ENTRY("fptosi", Instruction::CastOps::FPToSI),
+	OTHEROP_ENTRY("uitofp", Instruction::CastOps::UIToFP),
+	OTHEROP_ENTRY("sitofp", Instruction::CastOps::SIToFP),
+	INTRINSIC_ENTRY("fmuladd", fmuladd), INTRINSIC_ENTRY("fma", fma),
+	INTRINSIC_ENTRY("fabs", fabs), INTRINSIC_ENTRY("sqrt", sqrt),
+	INTRINSIC_ENTRY("smax", smax), INTRINSIC_ENTRY("smin", smin),
+	INTRINSIC_ENTRY("umax", umax), INTRINSIC_ENTRY("umin", umin),
+	INTRINSIC_ENTRY("maxnum", maxnum), INTRINSIC_ENTRY("minnum", minnum),
+	INTRINSIC_ENTRY("exp", exp), INTRINSIC_ENTRY("log", log),
+	INTRINSIC_ENTRY("sin", sin), INTRINSIC_ENTRY("cos", cos),
+	INTRINSIC_ENTRY("pow", pow), INTRINSIC_ENTRY("floor", floor),
+	INTRINSIC_ENTRY("ceil", ceil),
 });
 
 
@@ -314,11 +351,93 @@ InstMapEntry* InstMap::find(StringRef opcode)
 	return nullptr;
 }
 
+/**
+ * @details Entries are bucketed by the LLVM IR opcode they handle
+ * (and by the function name for custom instructions) so that find(Instruction*)
+ * only tests the entries which can match the instruction.
+ * The order of the entries in each bucket follows the order of addition.
+*/
+void InstMap::buildIndex()
+{
+	opcode_index.clear();
+	opcode_index.resize(Instruction::OtherOps::OtherOpsEnd);
+	custom_index.clear();
+	intrinsic_index.clear();
+
+	StringMap<entry_list> custom_by_name;
+	for (auto &entry : entries) {
+		if (auto custom = dyn_cast<CustomInstMapEntry>(entry.get())) {
+			custom_by_name[custom->getOpcodeName()].push_back(custom);
+		} else if (auto intrinsic = dyn_cast<IntrinsicMapEntry>(entry.get())) {
+			intrinsic_index[intrinsic->getIntrinsicID()].push_back(intrinsic);
+		} else {
+			unsigned opcode = entry->getIROpcode();
+			assert(opcode < opcode_index.size() && "invalid opcode of the entry");
+			opcode_index[opcode].push_back(entry.get());
+		}
+	}
+	// bind the custom instruction entries to the annotated functions
+	for (auto F : custom_funcs) {
+		auto it = custom_by_name.find(F->getName());
+		if (it != custom_by_name.end()) {
+			custom_index[F] = it->second;
+		}
+	}
+	index_valid = true;
+}
+
+void InstMap::setCost(function_ref<OpCost(StringRef)> get_cost)
+{
+	for (auto &entry : entries) {
+		entry->setCost(get_cost(entry->getMapName()));
+	}
+}
+
+StringSet<> InstMap::getMapNames()
+{
+	StringSet<> names;
+	for (auto &entry : entries) {
+		names.insert(entry->getMapName());
+	}
+	return names;
+}
+
+void InstMap::setCustomInstFunctions(ArrayRef<Function*> funcs)
+{
+	custom_funcs.assign(funcs.begin(), funcs.end());
+	index_valid = false;
+}
+
 InstMapEntry* InstMap::find(Instruction *I)
 {
-	for (auto it : entries) {
-		if (it->match(I)) {
-			return it.get();
+	if (!index_valid) {
+		buildIndex();
+	}
+
+	entry_list *candidates;
+	if (auto call = dyn_cast<CallBase>(I)) {
+		auto F = call->getCalledFunction();
+		if (!F) return nullptr;
+		if (F->isIntrinsic()) {
+			// intrinsic call is looked up by the intrinsic ID
+			auto it = intrinsic_index.find(F->getIntrinsicID());
+			if (it == intrinsic_index.end()) return nullptr;
+			candidates = &it->second;
+		} else {
+			// custom instruction is looked up by the callee
+			auto it = custom_index.find(F);
+			if (it == custom_index.end()) return nullptr;
+			candidates = &it->second;
+		}
+	} else {
+		unsigned opcode = I->getOpcode();
+		if (opcode >= opcode_index.size()) return nullptr;
+		candidates = &opcode_index[opcode];
+	}
+
+	for (auto entry : *candidates) {
+		if (entry->match(I)) {
+			return entry;
 		}
 	}
 	return nullptr;
@@ -341,6 +460,16 @@ bool BinaryOpMapEntry::match(Instruction *I)
 	}
 }
 
+/* ================== Implementation of UnaryOpMapEntry ================== */
+bool UnaryOpMapEntry::match(Instruction *I)
+{
+	if (auto unaryop = dyn_cast<UnaryOperator>(I)) {
+		return (unaryop->getOpcode() == this->ops) && map_cond->match(I);
+	} else {
+		return false;
+	}
+}
+
 /* ================== Implementation of MemoryOpMapEntry ================== */
 /**
  * @details Currently, only @a load and @a store instructions are considered
@@ -363,7 +492,7 @@ bool CompOpMapEntry::match(Instruction *I)
 	if (auto binop = dyn_cast<CmpInst>(I)) {
 		if (I->getOpcode() == Instruction::OtherOps::ICmp && isInteger) {
 			return map_cond->match(I);
-		} else if (I->getOpcode() == Instruction::OtherOps::ICmp 
+		} else if (I->getOpcode() == Instruction::OtherOps::FCmp 
 						&& !isInteger) {
 			return map_cond->match(I);
 		}
@@ -418,6 +547,20 @@ bool OtherOpMapEntry::match(Instruction *I)
 	return false;
 }
 
+unsigned OtherOpMapEntry::getIROpcode() const
+{
+	switch (cat) {
+		case OptCategory::Terminator:
+			return term_ops;
+		case OptCategory::Cast:
+			return cast_ops;
+		case OptCategory::Other:
+			return other_ops;
+		default:
+			llvm_unreachable("Unknown category for other operations");
+	}
+}
+
 /* ================= Implementation of CustomInstMapEntry ================= */
 /**
  * @details the function corresponding to the custom instruction must satisfy the following conditions
@@ -429,6 +572,8 @@ bool OtherOpMapEntry::match(Instruction *I)
  * __attribute__((annotate("cgra_custom_inst"))) int func(int x, int y);
  * @endcode 
  *
+ * The annotation is checked once for the whole module when the model is instantiated,
+ * and InstMap dispatches only the calls of the annotated functions to this entry.
 */
 bool CustomInstMapEntry::match(Instruction *I)
 {
@@ -436,20 +581,24 @@ bool CustomInstMapEntry::match(Instruction *I)
 	if (auto callop = dyn_cast<CallBase>(I)) {
 		auto F = callop->getCalledFunction();
 		// check the func name
-		if (F->getName() == opcode_str) {
-			// check the called function has the attributes
-			return isCustomOpFunc(F) && map_cond->match(I);
+		if (F && F->getName() == opcode_str) {
+			return map_cond->match(I);
 		}
 	}
 	return false;
 }
 
-bool CustomInstMapEntry::isCustomOpFunc(Function *F)
+/* ================= Implementation of IntrinsicMapEntry ================= */
+/**
+ * @details The intrinsic is identified with its ID regardless of the overloaded types.
+ * For example, "fmuladd" matches both @a llvm.fmuladd.f32 and @a llvm.fmuladd.f64.
+*/
+bool IntrinsicMapEntry::match(Instruction *I)
 {
-	auto *M = F->getParent();
-	auto &FAM = MAM.getResult<FunctionAnalysisManagerModuleProxy>(*M).getManager();
-	auto annot = FAM.getResult<AnnotationAnalysisPass>(*F);
-	return annot.contains(CGRAOMP_CUSTOM_INST_ATTR);
+	if (auto intrinsic = dyn_cast<IntrinsicInst>(I)) {
+		return (intrinsic->getIntrinsicID() == id) && map_cond->match(I);
+	}
+	return false;
 }
 
 /* ============ Utility functions for parsing the configration  ============ */
@@ -29,6 +29,7 @@
 */
 #include "CGRAModel.hpp"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/IR/InstrTypes.h"
@@ -144,6 +145,7 @@ Expected<CGRAModel::CGRACategory> CGRAOmp::getCategory(json::Object *json_obj,
 
 char conditional_key[] = COND_STYLE_KEY;
 char interloopdep_key[] = IDP_STYLE_KEY;
+char delayline_key[] = DELAY_LINE_KEY;
 
 
 /**
@@ -296,8 +298,251 @@ Expected<AddressGenerator*> CGRAOmp::createAffineAG(json::Object *json_obj,
 	}
 }
 
+Expected<int> CGRAOmp::getRegisterBudget(json::Object *json_obj,
+												StringRef filename)
+{
+	auto make_model_error = [&](auto... args) {
+		auto EI = std::make_unique<ModelError>(filename, args...);
+		EI->setRegion(DELAY_LINE_KEY);
+		return Error(std::move(EI));
+	};
+
+	if (json_obj->get(REG_BUDGET_KEY)) {
+		auto budget = json_obj->get(REG_BUDGET_KEY)->getAsInteger();
+		if (budget.hasValue()) {
+			if (*budget > 0) {
+				return (int)*budget;
+			} else {
+				// zero or negative integer
+				return make_model_error(REG_BUDGET_KEY, to_string(*budget),
+										ArrayRef<StringRef>({}));
+			}
+		} else {
+			// not integer
+			return make_model_error(REG_BUDGET_KEY, "integer",
+								json_obj->get(REG_BUDGET_KEY));
+		}
+	} else {
+		// no limitation regarding the register budget
+		return INT_MAX;
+	}
+}
+
+Expected<std::pair<int,int>> CGRAOmp::getMemoryBank(json::Object *json_obj,
+												StringRef filename)
+{
+	auto make_model_error = [&](auto... args) {
+		auto EI = std::make_unique<ModelError>(filename, args...);
+		EI->setRegion(MEM_BANK_KEY);
+		return Error(std::move(EI));
+	};
+
+	if (!json_obj) {
+		return make_error<ModelError>(filename, MEM_BANK_KEY, "object");
+	}
+
+	// get a positive integer for the key
+	auto get_positive = [&](StringRef key, int default_val) -> Expected<int> {
+		if (json_obj->get(key)) {
+			auto val = json_obj->get(key)->getAsInteger();
+			if (!val.hasValue()) {
+				// not integer
+				return make_model_error(key, "integer", json_obj->get(key));
+			} else if (*val <= 0) {
+				// zero or negative integer
+				return make_model_error(key, to_string(*val),
+										ArrayRef<StringRef>({}));
+			}
+			return (int)*val;
+		} else if (default_val > 0) {
+			return default_val;
+		} else {
+			// missing the key
+			return make_model_error(key);
+		}
+	};
+
+	auto banks = get_positive(BANK_NUM_KEY, 0);
+	if (!banks) {
+		return banks.takeError();
+	}
+	auto ports = get_positive(BANK_PORT_KEY, 1);
+	if (!ports) {
+		return ports.takeError();
+	}
+	return std::make_pair(*banks, *ports);
+}
+
+/**
+ * @details Each item of the JSON object is keyed by the map name of an operation:
+ * @code
+ * "op_cost": {
+ *     "default": { "latency": 1, "issue_interval": 1 },
+ *     "fdiv": { "latency": 8, "issue_interval": 4, "energy": 2.5 }
+ * }
+ * @endcode
+ * The latency and the issue interval are 1 if they are omitted.
+*/
+Expected<StringMap<OpCost>> CGRAOmp::getOpCostTable(json::Object *json_obj,
+												StringRef filename)
+{
+	auto make_model_error = [&](auto... args) {
+		auto EI = std::make_unique<ModelError>(filename, args...);
+		EI->setRegion(OP_COST_KEY);
+		return Error(std::move(EI));
+	};
+
+	if (!json_obj) {
+		return make_error<ModelError>(filename, OP_COST_KEY, "object");
+	}
+
+	StringMap<OpCost> table;
+	for (auto &item : *json_obj) {
+		auto *cost_obj = item.second.getAsObject();
+		if (!cost_obj) {
+			return make_model_error(OP_COST_KEY, "an object of cost",
+										&item.second);
+		}
+		OpCost cost;
+		// latency (non-negative)
+		if (auto *v = cost_obj->get(OP_LATENCY_KEY)) {
+			auto val = v->getAsInteger();
+			if (!val.hasValue()) {
+				return make_model_error(OP_LATENCY_KEY, "integer", v);
+			} else if (*val < 0) {
+				return make_model_error(OP_LATENCY_KEY, to_string(*val),
+										ArrayRef<StringRef>({}));
+			}
+			cost.latency = (int)*val;
+		}
+		// issue interval (positive)
+		if (auto *v = cost_obj->get(OP_II_KEY)) {
+			auto val = v->getAsInteger();
+			if (!val.hasValue()) {
+				return make_model_error(OP_II_KEY, "integer", v);
+			} else if (*val <= 0) {
+				return make_model_error(OP_II_KEY, to_string(*val),
+										ArrayRef<StringRef>({}));
+			}
+			cost.issue_interval = (int)*val;
+		}
+		// energy (optional, non-negative)
+		if (auto *v = cost_obj->get(OP_ENERGY_KEY)) {
+			auto val = v->getAsNumber();
+			if (!val.hasValue()) {
+				return make_model_error(OP_ENERGY_KEY, "number", v);
+			} else if (*val < 0) {
+				return make_model_error(OP_ENERGY_KEY, to_string(*val),
+										ArrayRef<StringRef>({}));
+			}
+			cost.energy = *val;
+		}
+		table[StringRef(item.first)] = cost;
+	}
+
+	return table;
+}
+
+/**
+ * @details Each item of the JSON array declares a class of PEs:
+ * @code
+ * "pe_classes": [
+ *     { "name": "alu", "ops": ["add", "sub", "icmp"], "count": 12 },
+ *     { "name": "mul", "ops": ["add", "mul"], "positions": [[0, 0], [3, 3]] }
+ * ]
+ * @endcode
+ * The operations are specified by the map names in the DFG.
+*/
+Expected<SmallVector<PEClass>> CGRAOmp::getPEClasses(json::Array *json_arr,
+												StringRef filename)
+{
+	auto make_model_error = [&](auto... args) {
+		auto EI = std::make_unique<ModelError>(filename, args...);
+		EI->setRegion(PE_CLASS_KEY);
+		return Error(std::move(EI));
+	};
+
+	if (!json_arr) {
+		return make_error<ModelError>(filename, PE_CLASS_KEY, "array");
+	}
+	if (json_arr->size() > MAX_PE_CLASSES) {
+		return make_model_error(PE_CLASS_KEY,
+					formatv("{0} classes (at most {1})", json_arr->size(),
+							MAX_PE_CLASSES).str(), ArrayRef<StringRef>({}));
+	}
+
+	SmallVector<PEClass> classes;
+	StringSet<> names;
+	for (auto &item : *json_arr) {
+		auto *class_obj = item.getAsObject();
+		if (!class_obj) {
+			return make_model_error(PE_CLASS_KEY, "an array of object", &item);
+		}
+		PEClass pe;
+		// name (unique)
+		if (auto *v = class_obj->get(PE_NAME_KEY)) {
+			auto name = v->getAsString();
+			if (!name.hasValue()) {
+				return make_model_error(PE_NAME_KEY, "string", v);
+			} else if (!names.insert(*name).second) {
+				// duplicated
+				return make_model_error(PE_NAME_KEY, *name,
+										ArrayRef<StringRef>({}));
+			}
+			pe.name = name->str();
+		} else {
+			return make_model_error(PE_NAME_KEY);
+		}
+		// supported operations
+		auto ops = getStringArray(class_obj, PE_OPS_KEY, filename);
+		if (!ops) {
+			return ops.takeError();
+		}
+		for (auto &op : *ops) {
+			pe.ops.insert(op);
+		}
+		// grid positions (optional)
+		if (auto *v = class_obj->get(PE_POS_KEY)) {
+			auto *pos_arr = v->getAsArray();
+			if (!pos_arr) {
+				return make_model_error(PE_POS_KEY, "an array of [x, y]", v);
+			}
+			for (auto &pos : *pos_arr) {
+				auto *xy = pos.getAsArray();
+				if (!xy || xy->size() != 2 || !(*xy)[0].getAsInteger() ||
+						!(*xy)[1].getAsInteger()) {
+					return make_model_error(PE_POS_KEY, "an array of [x, y]",
+												&pos);
+				}
+				pe.positions.emplace_back((int)*(*xy)[0].getAsInteger(),
+											(int)*(*xy)[1].getAsInteger());
+			}
+		}
+		// the number of PEs (positive)
+		if (auto *v = class_obj->get(PE_COUNT_KEY)) {
+			auto val = v->getAsInteger();
+			if (!val.hasValue()) {
+				return make_model_error(PE_COUNT_KEY, "integer", v);
+			} else if (*val <= 0 || (!pe.positions.empty() &&
+								*val != (int64_t)pe.positions.size())) {
+				// zero, negative or inconsistent with the positions
+				return make_model_error(PE_COUNT_KEY, to_string(*val),
+										ArrayRef<StringRef>({}));
+			}
+			pe.count = (int)*val;
+		} else if (!pe.positions.empty()) {
+			pe.count = pe.positions.size();
+		} else {
+			return make_model_error(PE_COUNT_KEY);
+		}
+		classes.push_back(std::move(pe));
+	}
+
+	return classes;
+}
+
 Expected<CGRAModel*> CGRAOmp::parseCGRASetting(StringRef filename,
-						ModuleAnalysisManager &MAM)
+						Module &M, ModuleAnalysisManager &MAM)
 {
 	//open json file
 	error_code fopen_ec;
@@ -355,6 +600,16 @@ Expected<CGRAModel*> CGRAOmp::parseCGRASetting(StringRef filename,
 					model = new DecoupledCGRA(filename, *AG,
 												*cond_type, *ild_type);
 					model->asDerived<DecoupledCGRA>()->getAG()->getKind();
+					// memory bank setting (optional)
+					if (auto *bank_val = top_obj->get(MEM_BANK_KEY)) {
+						auto bank = getMemoryBank(bank_val->getAsObject(),
+													filename);
+						if (!bank) {
+							return bank.takeError();
+						}
+						model->asDerived<DecoupledCGRA>()->setMemoryBank(
+												bank->first, bank->second);
+					}
 				} else {
 					return AG.takeError();
 				}
@@ -370,6 +625,62 @@ Expected<CGRAModel*> CGRAOmp::parseCGRASetting(StringRef filename,
 	}
 
 
+	// hardware loop counter support (optional)
+	if (auto *counter = top_obj->get(LOOP_COUNTER_KEY)) {
+		auto has_counter = counter->getAsBoolean();
+		if (has_counter.hasValue()) {
+			model->setLoopCounter(*has_counter);
+		} else {
+			// not bool type
+			return make_error<ModelError>(filename, LOOP_COUNTER_KEY, "bool",
+											counter);
+		}
+	}
+
+	// delay line for loop-carried dependency (optional)
+	if (top_obj->get(DELAY_LINE_KEY)) {
+		auto delay_style = getOption<delayline_key, CGRAModel::DelayLineStyle>(top_obj, filename, CGRAModel::DelayLineStyleMap);
+		if (!delay_style) {
+			return delay_style.takeError();
+		}
+		auto budget = getRegisterBudget(
+						top_obj->get(DELAY_LINE_KEY)->getAsObject(), filename);
+		if (!budget) {
+			return budget.takeError();
+		}
+		model->setDelayLine(*delay_style, *budget);
+	}
+
+	// wide memory access (optional)
+	if (auto *width = top_obj->get(MEM_WIDTH_KEY)) {
+		auto width_val = width->getAsInteger();
+		if (!width_val.hasValue()) {
+			// not integer
+			return make_error<ModelError>(filename, MEM_WIDTH_KEY, "integer",
+											width);
+		} else if (*width_val < 0) {
+			// negative integer
+			return make_error<ModelError>(filename, MEM_WIDTH_KEY,
+								to_string(*width_val), ArrayRef<StringRef>({}));
+		}
+		model->setMaxMemAccessWidth((int)*width_val);
+	}
+
+	// threshold for offloading (optional)
+	if (auto *count = top_obj->get(MIN_TRIP_COUNT_KEY)) {
+		auto count_val = count->getAsInteger();
+		if (!count_val.hasValue()) {
+			// not integer
+			return make_error<ModelError>(filename, MIN_TRIP_COUNT_KEY, "integer",
+											count);
+		} else if (*count_val < 0) {
+			// negative integer
+			return make_error<ModelError>(filename, MIN_TRIP_COUNT_KEY,
+								to_string(*count_val), ArrayRef<StringRef>({}));
+		}
+		model->setMinOffloadTripCount((int)*count_val);
+	}
+
 	// add supported instructions
 	auto inst_list = getStringArray(top_obj, GEN_INST_KEY, filename);
 	if (!inst_list) {
@@ -389,7 +700,7 @@ Expected<CGRAModel*> CGRAOmp::parseCGRASetting(StringRef filename,
 		return cust_list.takeError();
 	} else {
 		for (auto inst : *cust_list) {
-			model->addCustomInst(inst, MAM);
+			model->addCustomInst(inst);
 		}
 	}
 
@@ -409,6 +720,33 @@ Expected<CGRAModel*> CGRAOmp::parseCGRASetting(StringRef filename,
 		}
 	}
 
+	// cost of the mapped operations (optional)
+	if (auto *cost_val = top_obj->get(OP_COST_KEY)) {
+		auto table = getOpCostTable(cost_val->getAsObject(), filename);
+		if (!table) {
+			return table.takeError();
+		}
+		OpCost default_cost;
+		auto it = table->find(OP_DEFAULT_KEY);
+		if (it != table->end()) {
+			default_cost = it->second;
+			table->erase(it);
+		}
+		model->setOpCostTable(*table, default_cost);
+	}
+
+	// heterogeneous PE classes (optional)
+	if (auto *class_val = top_obj->get(PE_CLASS_KEY)) {
+		auto classes = getPEClasses(class_val->getAsArray(), filename);
+		if (!classes) {
+			return classes.takeError();
+		}
+		model->setPEClasses(*classes);
+	}
+
+	// build the dispatch table of instruction mapping
+	model->buildInstMapIndex(M, MAM);
+
 	return model;
 }
 
@@ -429,6 +767,11 @@ StringMap<CGRAModel::InterLoopDep> CGRAModel::InterLoopDepMap({
 	make_pair("generic", CGRAModel::InterLoopDep::Generic),
 	make_pair("BackwardInst", CGRAModel::InterLoopDep::BackwardInst),
 });
+// valid settings for delay line style
+StringMap<CGRAModel::DelayLineStyle> CGRAModel::DelayLineStyleMap({
+	make_pair("register_chain", CGRAModel::DelayLineStyle::RegisterChain),
+	make_pair("distance_edge", CGRAModel::DelayLineStyle::DistanceEdge),
+});
 
 
 Error CGRAModel::addSupportedInst(StringRef opcode)
@@ -436,9 +779,9 @@ Error CGRAModel::addSupportedInst(StringRef opcode)
 	return std::move(inst_map.add_generic_inst(opcode));
 }
 
-void CGRAModel::addCustomInst(StringRef opcode, ModuleAnalysisManager &MAM)
+void CGRAModel::addCustomInst(StringRef opcode)
 {
-	inst_map.add_custom_inst(opcode, MAM);
+	inst_map.add_custom_inst(opcode);
 }
 
 
@@ -452,14 +795,128 @@ Error CGRAModel::add_map_entry(StringRef opcode, MapCondition *map_cond)
 	}
 }
 
+void CGRAModel::setOpCostTable(const StringMap<OpCost> &table,
+								const OpCost &default_cost)
+{
+	op_cost = table;
+	default_op_cost = default_cost;
+	has_op_cost = true;
+	// costs of the operations not in the model are never used
+	auto map_names = inst_map.getMapNames();
+	for (auto &item : op_cost) {
+		if (!map_names.count(item.getKey())) {
+			errs() << formatv(WARN_MSG_PREFIX "cost of \"{0}\" is ignored "
+				"because no operation is mapped to it\n", item.getKey());
+		}
+	}
+	// each entry keeps the cost of its mapped operation
+	inst_map.setCost([&](StringRef map_name) {
+		return getOpCost(map_name);
+	});
+}
+
+void CGRAModel::buildInstMapIndex(Module &M, ModuleAnalysisManager &MAM)
+{
+	// find the functions annotated as custom instructions at once
+	auto &annot = MAM.getResult<ModuleAnnotationAnalysisPass>(M);
+	SmallVector<Function*> custom_funcs;
+	for (auto &F : M) {
+		auto it = annot.find(&F);
+		if (it != annot.end() && it->second.count(CGRAOMP_CUSTOM_INST_ATTR)) {
+			custom_funcs.push_back(&F);
+		}
+	}
+	inst_map.setCustomInstFunctions(custom_funcs);
+	inst_map.buildIndex();
+}
+
 InstMapEntry* CGRAModel::isSupported(Instruction *I)
 {
 	return inst_map.find(I);
 }
 
+unsigned CGRAModel::getPEClassMask(StringRef map_name) const
+{
+	unsigned mask = 0;
+	for (unsigned i = 0; i < pe_classes.size(); i++) {
+		if (pe_classes[i].ops.count(map_name)) {
+			mask |= 1U << i;
+		}
+	}
+	return mask;
+}
+
+SmallVector<StringRef> CGRAModel::getPEClassNames(StringRef map_name) const
+{
+	SmallVector<StringRef> names;
+	for (auto &pe : pe_classes) {
+		if (pe.ops.count(map_name)) {
+			names.push_back(pe.name);
+		}
+	}
+	return names;
+}
+
+/**
+ * @details Every operation must be executable on at least one PE class.
+ * For decoupled CGRAs, each operation also occupies a PE during the whole kernel execution.
+ * Thus, the operations must be assigned to the PEs without exceeding the count of each class.
+ * According to Hall's theorem, such an assignment exists if and only if,
+ * for any subset @f$ S @f$ of the classes, the number of operations executable only on @f$ S @f$
+ * does not exceed the total count of @f$ S @f$.
+ * For time-multiplexed CGRAs, the count only affects the initiation interval so that it is not checked.
+*/
+Optional<std::string> CGRAModel::checkPEDemand(const StringMap<unsigned> &demand) const
+{
+	if (!hasPEClasses()) {
+		return None;
+	}
+
+	// group the operations by the classes able to execute them
+	DenseMap<unsigned, unsigned> group_demand;
+	for (auto &item : demand) {
+		unsigned mask = getPEClassMask(item.getKey());
+		if (mask == 0) {
+			return formatv("no PE class can execute \"{0}\"",
+							item.getKey()).str();
+		}
+		group_demand[mask] += item.getValue();
+	}
+
+	if (category != CGRACategory::Decoupled) {
+		return None;
+	}
+
+	unsigned num_classes = pe_classes.size();
+	for (unsigned S = 1; S < (1U << num_classes); S++) {
+		unsigned required = 0, available = 0;
+		for (auto &item : group_demand) {
+			if ((item.first & ~S) == 0) {
+				required += item.second;
+			}
+		}
+		if (required == 0) continue;
+		SmallVector<StringRef> names;
+		for (unsigned i = 0; i < num_classes; i++) {
+			if (S & (1U << i)) {
+				available += pe_classes[i].count;
+				names.push_back(pe_classes[i].name);
+			}
+		}
+		if (required > available) {
+			return formatv("{0} operations require PE class {1} but only {2} PEs are available",
+						required, make_range(names.begin(), names.end()),
+						available).str();
+		}
+	}
+
+	return None;
+}
+
 /* ======= Implementation of DecoupleCGRA and replated classes ======= */
 DecoupledCGRA::DecoupledCGRA(const DecoupledCGRA &rhs) : 
-	CGRAModel(rhs)
+	CGRAModel(rhs), num_banks(rhs.num_banks),
+	ports_per_bank(rhs.ports_per_bank)
 {
 	using AGKind = AddressGenerator::Kind;
 	// copy as an actual derived class
@@ -73,6 +73,8 @@ AnnotationAnalysisPass::run(Function &F, FunctionAnalysisManager &AM)
 		if (anno_set != modResult->end()) {
 			return anno_set->second;
 		}
+		// the function has no annotation
+		return Result();
 	}
 
 	Result result;
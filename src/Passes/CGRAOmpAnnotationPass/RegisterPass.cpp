@@ -55,7 +55,7 @@ static void registerFunctionAnalyses(FunctionAnalysisManager &FAM)
 
 }
 
-static void registerAnnotationPasses(PassBuilder &PB)
+void CGRAOmp::registerAnnotationPasses(PassBuilder &PB)
 {
 	PB.registerAnalysisRegistrationCallback(registerModuleAnalyses);
 	PB.registerAnalysisRegistrationCallback(registerFunctionAnalyses);
@@ -93,6 +93,22 @@ string GlobalDataNode::getNodeAttr() const {
 }
 
 
+string CounterNode::getNodeAttr() const {
+	string attr = formatv("type=op,{0}=counter,step={1},nest={2}",
+							OptDFGOpKey, step, nest_level);
+	if (auto *cint = dyn_cast_or_null<ConstantInt>(start)) {
+		attr += formatv(",start={0}", cint->getSExtValue());
+	}
+	if (auto *cint = dyn_cast_or_null<ConstantInt>(bound)) {
+		attr += formatv(",bound={0}", cint->getSExtValue());
+	}
+	if (pred != CmpInst::BAD_ICMP_PREDICATE) {
+		attr += formatv(",cmp={0}", CmpInst::getPredicateName(pred));
+	}
+	return attr;
+}
+
+
 /* ================== Implementation of CGRADFG ================== */
 CGRADFG::NodeType* CGRADFG::addNode(NodeType &N)
 {
@@ -122,6 +138,120 @@ bool CGRADFG::connect(NodeType &Src, NodeType &Dst, EdgeType &E)
 	return result;
 }
 
+CGRADFG::NodeType* CGRADFG::findOperandNode(const NodeType &N,
+												int operand) const
+{
+	SmallVector<EdgeInfoType> in_edges;
+	if (findIncomingEdgesToNode(N, in_edges, true)) {
+		for (auto EI : in_edges) {
+			for (auto E : EI.second) {
+				if (E->getOperand() == operand &&
+						E->getKind() == DFGEdge::EdgeKind::Normal) {
+					return EI.first;
+				}
+			}
+		}
+	}
+	return nullptr;
+}
+
+void CGRADFG::replaceAllUsesWith(NodeType &From, NodeType &To)
+{
+	EdgeListTy edges(From.begin(), From.end());
+	for (auto E : edges) {
+		From.removeEdge(*E);
+		To.addEdge(*E);
+	}
+}
+
+/**
+ * @details Loop control nodes (counters) and nodes shared by the other nodes
+ * (constants and global data) are kept even if they become dead
+ * because the loop and the other kernels merged into this graph still rely on them.
+ * The removed nodes are owned by this graph until it is destroyed
+ * because DFG passes may still hold their pointers.
+ */
+void CGRADFG::removeNodeAndDeadOperands(NodeType &N)
+{
+	SmallVector<EdgeInfoType> in_edges;
+	findIncomingEdgesToNode(N, in_edges, true);
+	EdgeListTy out_edges(N.begin(), N.end());
+	if (!CGRADFGBase::removeNode(N)) {
+		// already removed
+		return;
+	}
+	for (auto EI : in_edges) {
+		for (auto E : EI.second) {
+			delete E;
+		}
+	}
+	for (auto E : out_edges) {
+		delete E;
+	}
+	removed_nodes.emplace_back(&N);
+
+	for (auto EI : in_edges) {
+		auto Src = EI.first;
+		if (!Src->getEdges().empty()) continue;
+		switch (Src->getKind()) {
+			case DFGNode::NodeKind::Counter:
+			case DFGNode::NodeKind::Constant:
+			case DFGNode::NodeKind::GlobalData:
+				break;
+			default:
+				removeNodeAndDeadOperands(*Src);
+		}
+	}
+}
+
+unsigned CGRADFG::getNumEdges() const
+{
+	unsigned count = 0;
+	for (auto *N : Nodes) {
+		if (N == virtual_root) continue;
+		count += N->getEdges().size();
+	}
+	return count;
+}
+
+void CGRADFG::mergeGraph(CGRADFG &G)
+{
+	auto &other_root = G.getRoot();
+	for (auto *N : G.Nodes) {
+		if (N == &other_root) continue;
+		// share constants and global data
+		if (N->getKind() == DFGNode::NodeKind::Constant ||
+				N->getKind() == DFGNode::NodeKind::GlobalData) {
+			NodeType *existing = nullptr;
+			for (auto V : Nodes) {
+				if (*N == *V) {
+					existing = V;
+					break;
+				}
+			}
+			if (existing) {
+				replaceAllUsesWith(*N, *existing);
+				continue;
+			}
+		}
+		CGRADFGBase::addNode(*N);
+		// re-connect the virtual root
+		EdgeListTy vedges;
+		if (other_root.findEdgesTo(*N, vedges)) {
+			auto E = new DFGEdge(*N);
+			CGRADFGBase::connect(getRoot(), *N, *E);
+		}
+	}
+
+	// leave only the virtual root in G
+	EdgeListTy root_edges(other_root.begin(), other_root.end());
+	for (auto E : root_edges) {
+		other_root.removeEdge(*E);
+	}
+	G.Nodes.clear();
+	G.CGRADFGBase::addNode(other_root);
+}
+
 /**
  * @details If OptDFGPlainNodeName option is enabled,
  * this method calls convertToReadableNodeName.
@@ -177,6 +307,9 @@ Error CGRADFG::saveExtraInfo(StringRef filepath)
 
 	if (!EC) {
 		JS.object([&]() {
+			if (!graph_info.empty()) {
+				JS.attribute("__GRAPH", json::Object(graph_info));
+			}
 			for (auto *Node : Nodes) {
 				if (Node->hasExtraInfo()) {	
 					JS.attribute(Node->getUniqueName(), 
@@ -36,8 +36,28 @@ using namespace llvm;
 using namespace cl;
 using namespace std;
 
-cl::opt<string> CGRAOmp::PathToCGRAConfig("cgra-model",
-			cl::init("model.json"), cl::desc("Path to CGRA config file"),
+cl::list<string> CGRAOmp::PathToCGRAConfig("cgra-model",
+			cl::desc("Path to CGRA config file (default: model.json). "
+					"DFGs are extracted for each model if more than one is specified"),
+			cl::value_desc("<filepath>,..."), cl::CommaSeparated);
+
+cl::opt<string> CGRAOmp::OptDSESummaryFile("dse-summary",
+			cl::init("dse_summary.csv"),
+			cl::desc("Save a summary table of all the models as CSV when more than one model is specified"),
+			cl::value_desc("<filepath>"));
+
+cl::opt<string> CGRAOmp::OptDFGManifestFile("dfg-manifest",
+			cl::init(""),
+			cl::desc("Save the list of generated DFGs ranked by the kernel weight as JSON"),
+			cl::value_desc("<filepath>"));
+
+cl::opt<bool> CGRAOmp::OptFuseKernels("cgraomp-fuse-kernels",
+			cl::init(false),
+			cl::desc("Fuse DFGs of consecutive target regions sharing data into one DFG"));
+
+cl::opt<string> CGRAOmp::OptFusionHostIR("cgraomp-fusion-host-ir",
+			cl::init(""),
+			cl::desc("Host IR to check that the fused target regions are launched consecutively (kernels are not fused without it)"),
 			cl::value_desc("<filepath>"));
 
 cl::alias CGRAOmp::PathToCGRAConfigAlias("cm",
@@ -91,12 +111,17 @@ cl::opt<bool> CGRAOmp::OptUseSimpleDFGName("simplify-dfg-name",
 cl::opt<int> CGRAOmp::OptMemoryDependencyDistanceThreshold(
 			"memory-dependence-distance-threshold",
 			cl::init(1),
-			cl::desc("Threshold count for how close memory dependency is regarded as a data dependency in data flow graph (Default: 1)"));
+			cl::desc("Threshold count for how close memory dependency is regarded as a data dependency in data flow graph (Default: derived from the delay line setting of the CGRA model)"));
 
 cl::opt<bool> CGRAOmp::OptEnableLoopFlatten("cgraomp-loop-flatten",
 			cl::init(false),
 			cl::desc("Enable loop flatten pass for CGRA kernels"));
 
+cl::opt<string> CGRAOmp::OptTransferPlanFile("transfer-plan-file",
+			cl::init("transfer_plan.json"),
+			cl::desc("Path to the data transfer plan report of target directives"),
+			cl::value_desc("<filepath>"));
+
 cl::opt<int> CGRAOmp::OptDFGFloatPrecWidth(
 			"dfg-float-precision-width",
 			cl::init(4),
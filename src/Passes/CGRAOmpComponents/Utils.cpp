@@ -153,4 +153,54 @@ int Utils::getDataWidth(const Type* T)
 		default:
 			return 0;
 	}
-}
\ No newline at end of file
+}
+
+bool Utils::isAccessedBetween(Instruction *From, Instruction *To,
+							const MemoryLocation &Loc, Loop &L,
+							LoopStandardAnalysisResults &AR,
+							bool check_read, ArrayRef<Instruction*> ignore)
+{
+	for (auto BB : L.blocks()) {
+		for (auto &I : *BB) {
+			if (&I == From || &I == To || is_contained(ignore, &I)) continue;
+			if (!I.mayWriteToMemory() &&
+					!(check_read && I.mayReadFromMemory())) continue;
+			// executed before From or after To
+			if (AR.DT.dominates(&I, From) || AR.DT.dominates(To, &I)) continue;
+			auto MRI = AR.AA.getModRefInfo(&I, Loc);
+			if (isModSet(MRI) || (check_read && isRefSet(MRI))) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/// assumed trip count of a loop whose trip count is unknown at compile time
+static const unsigned DefaultTripCount = 100;
+
+double Utils::getLoopWeight(Loop &L, LoopStandardAnalysisResults &AR)
+{
+	unsigned body_size = 0;
+	for (auto BB : L.blocks()) {
+		body_size += BB->sizeWithoutDebug();
+	}
+
+	// the number of iterations
+	auto header = L.getHeader();
+	auto BFI = AR.BFI;
+	if (BFI && header->getParent()->hasProfileData()) {
+		// absolute execution count of the header
+		if (auto count = BFI->getBlockProfileCount(header)) {
+			return (double)(*count) * (double)body_size;
+		}
+	}
+	// static estimate by the trip counts
+	double trip_count = 1.0;
+	for (Loop *CurL = &L; CurL; CurL = CurL->getParentLoop()) {
+		unsigned TC = AR.SE.getSmallConstantTripCount(CurL);
+		if (TC == 0) TC = AR.SE.getSmallConstantMaxTripCount(CurL);
+		trip_count *= (TC != 0) ? TC : DefaultTripCount;
+	}
+	return trip_count * (double)body_size;
+}
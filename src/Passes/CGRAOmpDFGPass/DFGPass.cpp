@@ -37,6 +37,8 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/Debug.h"
 
 #include "llvm/IR/InstrTypes.h"
@@ -51,10 +53,16 @@
 #include "DecoupledAnalysis.hpp"
 #include "LoopDependencyAnalysis.hpp"
 #include "AGVerifyPass.hpp"
+#include "BankAssignmentAnalysis.hpp"
 #include "Utils.hpp"
+#include "KernelHint.hpp"
 
 #include "BalanceTree.hpp"
+#include "MemoryAccessOpt.hpp"
+#include "LineBufferReuse.hpp"
+#include "WideMemoryAccess.hpp"
 
+#include <algorithm>
 #include <queue>
 #include <system_error>
 
@@ -196,6 +204,7 @@ PreservedAnalyses DFGPassHandler::run(Module &M, ModuleAnalysisManager &AM)
 	}
 
 	StringMap<int> kernel_count;
+	array_banks.clear();
 
 	// obtain OpenMP kernels
 	auto &kernel_info = AM.getResult<OmpKernelAnalysisPass>(M);
@@ -214,39 +223,149 @@ PreservedAnalyses DFGPassHandler::run(Module &M, ModuleAnalysisManager &AM)
 		}
 	}
 	
-	// Optimize and export each generated DFG
+	// tuning hints of each kernel (if any)
+	auto *hints = AM.getCachedResult<KernelHintAnalysisPass>(M);
+	auto get_hint = [&](Function *F) -> const KernelHint* {
+		return hints ? hints->getHint(F) : nullptr;
+	};
+	// pass pipelines given by the hints
+	StringMap<DFGPassManager*> hinted_DPM;
+
+	// Optimize each generated DFG
 	for (auto G : graphs()) {
 		auto F = G->getFunction();
 		auto L = G->getLoop();
 		auto AR = getLSAR(*F, FAM);
 		auto &LAM = FAM.getResult<LoopAnalysisManagerFunctionProxy>(*F).getManager();
 
+		// the pipeline in the hint overrides -dfg-pass-pipeline
+		auto *PM = DPM;
+		auto hint = get_hint(F);
+		if (hint && hint->dfg_pipeline) {
+			auto &pipeline = *hint->dfg_pipeline;
+			auto &hinted = hinted_DPM[join(pipeline, ",")];
+			if (!hinted) {
+				hinted = new DFGPassManager();
+				Error E = DPB->parsePassPipeline(*hinted, pipeline);
+				if (E) {
+					ExitOnError Exit(ERR_MSG_PREFIX);
+					Exit(std::move(E));
+				}
+			}
+			PM = hinted;
+		}
+
 		// apply DFG Passes
-		DPM->run(*G, *L, FAM, LAM, AR);
+		PM->run(*G, *L, FAM, LAM, AR);
+	}
+	for (auto &item : hinted_DPM) {
+		delete item.second;
+	}
 
-		// use plain node name istread of pointer values
-		if (OptDFGPlainNodeName) {
-			G->makeSequentialNodeID();
+	// consumer kernels fused into the DFG of their producer
+	SmallVector<std::pair<CGRADFG*, Function*>> fused;
+
+	// fuse DFGs of consecutive kernels
+	if (OptFuseKernels) {
+		auto &fusion_info = AM.getResult<KernelFusionAnalysisPass>(M);
+		auto find_graph = [&](Function *F, Loop *L) -> CGRADFG* {
+			for (auto G : graphs()) {
+				if (G->getFunction() == F && G->getLoop() == L) {
+					return G;
+				}
+			}
+			return nullptr;
+		};
+		for (auto &C : fusion_info.candidates()) {
+			auto Producer = find_graph(C.producer, C.producer_loop);
+			auto Consumer = find_graph(C.consumer, C.consumer_loop);
+			if (!Producer || !Consumer) continue;
+			if (fuseDataFlowGraphs(*Producer, *Consumer, C)) {
+				removeGraph(Consumer);
+				fused.emplace_back(Producer, C.consumer);
+			}
 		}
+	}
 
-		// determine export name
-		std::string fname, label;
+	// kernels listed in the manifest with their weights
+	SmallVector<std::pair<double, json::Object>> manifest;
+	// kernels rejected by the verification
+	SmallVector<json::Object> rejected;
+
+	// name of the kernel used for the DFG
+	auto get_label = [&](Function *F) -> std::string {
 		auto offload_func = kernel_info.getOffloadFunction(F);
 		auto md = kernel_info.getMetadata(offload_func);
-		
 		if (OptUseSimpleDFGName && md != kernel_info.md_end()) {
 			// use original function name instead of offloading function name
-			label = formatv("{0}_{1}_{2}", module_name, md->func_name,
+			return formatv("{0}_{1}_{2}", module_name, md->func_name,
 											md->order);
 		} else {
-			label = formatv("{0}_{1}", module_name, offload_func->getName());
+			return formatv("{0}_{1}", module_name, offload_func->getName());
+		}
+	};
+
+	// export each DFG
+	for (auto G : graphs()) {
+		auto F = G->getFunction();
+		auto L = G->getLoop();
+		auto AR = getLSAR(*F, FAM);
+
+		// estimated dynamic weight of the kernel
+		auto weight = getLoopWeight(*L, AR);
+		G->setGraphExtraInfo("weight", weight);
+		G->setGraphExtraInfo("profiled", F->hasProfileData());
+
+		// the fused consumers must not be launched by themselves
+		json::Array fused_kernels;
+		for (auto &item : fused) {
+			if (item.first == G) {
+				fused_kernels.push_back(get_label(item.second));
+			}
+		}
+		if (!fused_kernels.empty()) {
+			G->setGraphExtraInfo("fused", json::Array(fused_kernels));
+		}
+
+		// hints for the mapper
+		if (auto hint = get_hint(F)) {
+			if (hint->ii) {
+				G->setGraphExtraInfo("target_ii", *hint->ii);
+			}
+			if (hint->max_fanout) {
+				G->setGraphExtraInfo("max_fanout", *hint->max_fanout);
+			}
+			if (hint->unroll) {
+				G->setGraphExtraInfo("unroll", *hint->unroll);
+			}
+		}
+
+		// annotate the PE classes able to execute each operation
+		if (model->hasPEClasses()) {
+			for (auto *N : make_range(G->begin(), G->end())) {
+				if (auto *comp_node = dyn_cast<ComputeNode>(N)) {
+					auto names = model->getPEClassNames(comp_node->getOpcode());
+					comp_node->setPEClass(join(names, "|"));
+				}
+			}
 		}
 
+		// use plain node name istread of pointer values
+		if (OptDFGPlainNodeName) {
+			G->makeSequentialNodeID();
+		}
+
+		// determine export name
+		std::string fname;
+		std::string label = get_label(F);
+
 		if (OptDFGFilePrefix != "") {
 			fname = formatv("{0}_{1}_{2}.dot", OptDFGFilePrefix, label, L->getName());
 		} else {
 			fname = formatv("./{1}_{2}.dot", parent, label, L->getName());
 		}
+		// separate directory for each model
+		fname = MM.getOutputPath(fname);
 		G->setName(label);
 
 		LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << "Saving DFG: " << fname << "\n");
@@ -256,6 +375,19 @@ PreservedAnalyses DFGPassHandler::run(Module &M, ModuleAnalysisManager &AM)
 			ExitOnError Exit(ERR_MSG_PREFIX);
 			Exit(std::move(E));
 		}
+		json::Object entry({
+			{"kernel", label},
+			{"loop", L->getName().str()},
+			{"dfg", fname},
+			{"weight", weight},
+			{"profiled", F->hasProfileData()},
+			{"nodes", G->getNumNodes()},
+			{"edges", G->getNumEdges()},
+			{"verdict", "valid"},
+		});
+		if (!fused_kernels.empty()) {
+			entry["fused"] = std::move(fused_kernels);
+		}
 
 		if (G->hasExtraInfo()) {
 			if (OptDFGFilePrefix != "") {
@@ -263,18 +395,160 @@ PreservedAnalyses DFGPassHandler::run(Module &M, ModuleAnalysisManager &AM)
 			} else {
 				fname = formatv("./{1}_{2}_extra.json", parent, label, L->getName());
 			}
+			fname = MM.getOutputPath(fname);
 			E = G->saveExtraInfo(fname);
 			if (E) {
 				ExitOnError Exit(ERR_MSG_PREFIX);
 				Exit(std::move(E));
 			}
+			entry["extra"] = fname;
 		}
+		manifest.emplace_back(weight, std::move(entry));
 
+		// statistics for the model summary
+		auto &S = MM.getSummary();
+		S.dfgs++;
+		S.nodes += G->getNumNodes();
+		S.edges += G->getNumEdges();
+	}
+
+	if (OptDFGManifestFile != "") {
+		// loops failing the verification are also listed with the reasons
+		for (auto F : kernel_info.kernels()) {
+			VerifyResult *VR = nullptr;
+			switch(model->getKind()) {
+				case CGRAModel::CGRACategory::Decoupled:
+					VR = FAM.getCachedResult<DecoupledVerifyPass>(*F);
+					break;
+				case CGRAModel::CGRACategory::TimeMultiplexed:
+					VR = FAM.getCachedResult<TimeMultiplexedVerifyPass>(*F);
+					break;
+			}
+			if (!VR) continue;
+			for (auto &item : VR->rejected()) {
+				json::Array violations;
+				for (auto &name : item.second) {
+					violations.push_back(name);
+				}
+				rejected.push_back(json::Object({
+					{"kernel", get_label(F)},
+					{"loop", item.first->getName().str()},
+					{"verdict", "invalid"},
+					{"violations", std::move(violations)},
+				}));
+			}
+		}
+		Error E = saveManifest(MM.getOutputPath(OptDFGManifestFile), manifest,
+								rejected);
+		if (E) {
+			ExitOnError Exit(ERR_MSG_PREFIX);
+			Exit(std::move(E));
+		}
 	}
 	
 	return PreservedAnalyses::all();
 }
 
+/**
+ * @details The kernels are sorted in descending order of the weight
+ * so that the hottest kernel is mapped first.
+ */
+Error DFGPassHandler::saveManifest(StringRef filepath,
+				SmallVectorImpl<std::pair<double, json::Object>> &entries,
+				ArrayRef<json::Object> rejected)
+{
+	std::stable_sort(entries.begin(), entries.end(),
+		[](const std::pair<double, json::Object> &A,
+			const std::pair<double, json::Object> &B) {
+			return A.first > B.first;
+		});
+
+	error_code EC;
+	raw_fd_ostream File(filepath, EC, sys::fs::OpenFlags::F_Text);
+	if (EC) {
+		return errorCodeToError(EC);
+	}
+	json::OStream JS(File, 4);
+	JS.object([&]() {
+		JS.attributeArray("kernels", [&]() {
+			int rank = 0;
+			for (auto &entry : entries) {
+				entry.second["rank"] = rank++;
+				JS.value(json::Object(entry.second));
+			}
+		});
+		JS.attributeArray("rejected", [&]() {
+			for (auto &entry : rejected) {
+				JS.value(json::Object(entry));
+			}
+		});
+	});
+	return ErrorSuccess();
+}
+
+void DFGPassHandler::checkBankConsistency(const BankAssignment &BA,
+												StringRef kernel_name)
+{
+	for (auto &entry : BA.getArrayBanks()) {
+		// arrays are identified by name across the kernels as in AGConfig
+		auto base = entry.first;
+		if (!base->hasName()) continue;
+		auto it = array_banks.try_emplace(base->getName(),
+							entry.second, kernel_name.str()).first;
+		auto &placed = it->second;
+		if (placed.first != entry.second) {
+			errs() << formatv(WARN_MSG_PREFIX "array \"{0}\" is placed in bank {1}"
+							" for {2} but in bank {3} for {4}\n", base->getName(),
+							placed.first, placed.second, entry.second, kernel_name);
+		}
+	}
+}
+
+bool DFGPassHandler::fuseDataFlowGraphs(CGRADFG &Producer, CGRADFG &Consumer,
+										FusionCandidate &C)
+{
+	// memory accesses are compute nodes in the DFGs for TMCGRAs
+	auto find_node = [](CGRADFG &G, Value *V) -> DFGNode* {
+		for (auto N : G) {
+			if ((isa<MemAccessNode>(N) || isa<ComputeNode>(N)) &&
+					N->getValue() == V) {
+				return N;
+			}
+		}
+		return nullptr;
+	};
+
+	// pairs of a consumer load node and the source of the forwarded value
+	SmallVector<std::pair<DFGNode*, DFGNode*>> forward_list;
+	for (auto &entry : C.forward) {
+		auto load_node = find_node(Consumer, entry.first);
+		auto store_node = find_node(Producer, entry.second);
+		DFGNode *value_node = nullptr;
+		if (store_node) {
+			value_node = Producer.findOperandNode(*store_node, 0);
+		}
+		if (!load_node || !value_node) {
+			LLVM_DEBUG(dbgs() << WARN_DEBUG_PREFIX << formatv(
+				"Cannot fuse {0} into {1} because a forwarded access is not found in the DFGs\n",
+				C.consumer->getName(), C.producer->getName()));
+			return false;
+		}
+		forward_list.emplace_back(load_node, value_node);
+	}
+
+	Producer.mergeGraph(Consumer);
+	for (auto &entry : forward_list) {
+		Producer.replaceAllUsesWith(*entry.first, *entry.second);
+		Producer.removeNodeAndDeadOperands(*entry.first);
+	}
+
+	LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << formatv(
+		"{0} is fused into {1} forwarding {2} accesses\n",
+		C.consumer->getName(), C.producer->getName(), forward_list.size()));
+
+	return true;
+}
+
 
 template<typename VerifyPassT>
 void DFGPassHandler::createDataFlowGraphsForAllKernels(Function &F, FunctionAnalysisManager &AM)
@@ -306,9 +580,8 @@ void DFGPassHandler::createDataFlowGraph<DecoupledVerifyPass>(Function &F, Loop
 {
 	//get decoupled memory access for the kernel
 	auto &DA = LAM.getResult<DecoupledAnalysisPass>(L, AR);
-	//get the CGRA model
-	auto &MM = FAM.getResult<ModelManagerFunctionProxy>(F);
-	auto *model = MM.getModel();
+	//get the instruction mapping shared with the verification
+	auto &IM = FAM.getResult<InstMapAnalysisPass>(F);
 
 	auto verify_result = FAM.getResult<DecoupledVerifyPass>(F);
 	auto loop_verify_result = verify_result.getLoopVerifyResult(&L);
@@ -321,6 +594,10 @@ void DFGPassHandler::createDataFlowGraph<DecoupledVerifyPass>(Function &F, Loop
 
 	auto G = new CGRADFG(&F, &L);
 
+	// memory bank assignment of each stream (if available)
+	auto &BA = LAM.getResult<BankAssignmentAnalysisPass>(L, AR);
+	checkBankConsistency(BA, formatv("{0}:{1}", F.getName(), L.getName()).str());
+
 	// add memory load
 	error_code EC;
 	for (auto inst : DA.get_loads()) {
@@ -328,6 +605,9 @@ void DFGPassHandler::createDataFlowGraph<DecoupledVerifyPass>(Function &F, Loop
 		NewNode = G->addNode(*NewNode);
 		value_to_node[inst] = NewNode;
 		NewNode->setExtraInfo("AGConfig", ag_compat->getConfigAsJson(inst));
+		if (auto slot = BA.getSlotAsJson(inst)) {
+			NewNode->setExtraInfo("MemoryBank", *slot);
+		}
 	}
 	// add memory store
 	for (auto inst : DA.get_stores()) {
@@ -335,19 +615,22 @@ void DFGPassHandler::createDataFlowGraph<DecoupledVerifyPass>(Function &F, Loop
 		NewNode = G->addNode(*NewNode);
 		value_to_node[inst] = NewNode;
 		NewNode->setExtraInfo("AGConfig", ag_compat->getConfigAsJson(inst));
+		if (auto slot = BA.getSlotAsJson(inst)) {
+			NewNode->setExtraInfo("MemoryBank", *slot);
+		}
 	}
 
 	// add comp node
 	for (auto user : DA.get_comps()) {
 		if (auto *inst = dyn_cast<Instruction>(user)) {
-			if (auto *imap = model->isSupported(inst)) {
+			if (IM.isSupported(inst)) {
 				// if (auto binop = dyn_cast<BinaryOpMapEntry>(imap)) {
-				auto NewNode = make_comp_node(inst, imap->getMapName());
+				auto NewNode = make_comp_node(inst, IM.getMapName(inst).str());
 				NewNode = G->addNode(*NewNode);
 				value_to_node[inst] = NewNode;
 
-				if (auto customop = dyn_cast<CustomInstMapEntry>(imap)) {
-
+				// the last operand of custom instructions and intrinsics is the callee
+				if (isa<CallBase>(inst)) {
 					custom_op.insert(inst);
 				}
 			} else {
@@ -429,6 +712,8 @@ void DFGPassHandler::createDataFlowGraph(Function &F, Loop &L, FunctionAnalysisM
 
 	// get verification result
 	VerifyResult& verify_result = FAM.getResult<TimeMultiplexedVerifyPass>(F);
+	//get the instruction mapping shared with the verification
+	auto &IM = FAM.getResult<InstMapAnalysisPass>(F);
 	LoopVerifyResult* LVR = verify_result.getLoopVerifyResult(&L);
 	assert(LVR && "Failed to get loop verify result");
 
@@ -490,6 +775,77 @@ void DFGPassHandler::createDataFlowGraph(Function &F, Loop &L, FunctionAnalysisM
 	Instruction* BackBranch = LVR->getBackBranch(&L);
 	Instruction* LoopCond = LVR->getBackCondition(&L);
 
+	// to get the node for data coming from outside of the loop
+	auto get_data_node = [&](Value *V) {
+		DFGNode* DataNode;
+		if (!is_node_exist(V)) {
+			if (isa<Constant>(*V)) {
+				DataNode = make_const_node(V);
+			} else {
+				DataNode = make_global_node(V);
+			}
+			value_to_node[V] = DataNode;
+			DataNode = G->addNode(*DataNode);
+		} else {
+			DataNode = value_to_node[V];
+		}
+		return DataNode;
+	};
+
+	// replace induction variables with loop counters if available
+	// a counter needs the bound and the predicate to terminate by itself
+	SmallPtrSet<PHINode*, 4> counter_phis;
+	SmallPtrSet<Instruction*, 16> counter_ctrl; // instructions handled by counters
+	if (model->hasLoopCounter()) {
+		for (auto item : idv_phis) {
+			auto phi = item.first;
+			auto idv = static_cast<InductionVariableDependency*>(item.second);
+			if (!idv->getBound() ||
+					idv->getBoundPredicate() == CmpInst::BAD_ICMP_PREDICATE) {
+				LLVM_DEBUG(dbgs() << WARN_DEBUG_PREFIX << "the bound of "
+							<< phi->getName() << " is unknown and it is not mapped to a loop counter\n");
+				continue;
+			}
+			counter_phis.insert(phi);
+			auto step = cast<ConstantInt>(idv->getStep())->getSExtValue();
+			auto NewNode = make_counter_node(phi, idv->getStart(), step,
+									idv->getBound(), idv->getBoundPredicate(),
+									idv->getNestLevel());
+			NewNode = G->addNode(*NewNode);
+			value_to_node[phi] = NewNode;
+
+			// non-constant start and bound are given via edges
+			Value* params[] = {idv->getStart(), idv->getBound()};
+			for (int i = 0; i < 2; i++) {
+				if (params[i] && !isa<ConstantInt>(*params[i])) {
+					auto ParamEdge = new DFGEdge(*NewNode, i);
+					assert(G->connect(*get_data_node(params[i]), *NewNode, *ParamEdge) && "Trying to connect non-exist nodes");
+				}
+			}
+
+			// exit condition is also handled by the counter
+			if (auto cond = idv->getExitCond()) {
+				counter_ctrl.insert(cond);
+				for (auto U : cond->users()) {
+					if (auto br = dyn_cast<BranchInst>(U)) {
+						counter_ctrl.insert(br);
+					}
+				}
+			}
+		}
+		// the step instruction is not necessary if it is used only for the loop control
+		for (auto item : idv_phis) {
+			if (!counter_phis.contains(item.first)) continue;
+			auto I = item.second->getDefInst();
+			if (all_of(I->users(), [&](User *U) {
+					return U == item.first ||
+						counter_ctrl.contains(dyn_cast<Instruction>(U));
+				})) {
+				counter_ctrl.insert(I);
+			}
+		}
+	}
+
 
 	// make a node for each instruction in the kernel
 	for (auto &BB : all_blocks) {
@@ -503,15 +859,17 @@ void DFGPassHandler::createDataFlowGraph(Function &F, Loop &L, FunctionAnalysisM
 			} else if (auto gep = dyn_cast<GetElementPtrInst>(inst)) {
 				gep_set.insert(gep);
 				continue;
-			} else if (inst == BackBranch || inst == LoopCond) {
+			} else if (inst == BackBranch || inst == LoopCond ||
+						counter_ctrl.contains(inst)) {
 				continue;
 			}
 
-			if (auto *imap = model->isSupported(inst)) {
-				auto NewNode = make_comp_node(inst, imap->getMapName());
+			if (IM.isSupported(inst)) {
+				auto NewNode = make_comp_node(inst, IM.getMapName(inst).str());
 				NewNode = G->addNode(*NewNode);
 				value_to_node[inst] = NewNode;
-				if (auto customop = dyn_cast<CustomInstMapEntry>(imap)) {
+				// the last operand of custom instructions and intrinsics is the callee
+				if (isa<CallBase>(inst)) {
 					custom_op.insert(inst);
 				}
 				kernel_inst.insert(inst);
@@ -576,21 +934,7 @@ void DFGPassHandler::createDataFlowGraph(Function &F, Loop &L, FunctionAnalysisM
 				// making other instructions refer this instruction instead of the phi node
 				value_to_node[phi] = self;
 				// also making init edge
-				auto init_data = dep->getInit();
-				DFGNode* InitNode;
-				if (!is_node_exist(init_data)) {
-					if (isa<Constant>(*init_data)) {
-						InitNode = make_const_node(init_data);
-						value_to_node[init_data] = InitNode;
-						InitNode = G->addNode(*InitNode);
-					} else {
-						InitNode = make_global_node(init_data);
-						value_to_node[init_data] = InitNode;
-						InitNode = G->addNode(*InitNode);
-					}
-				} else {
-					InitNode = value_to_node[init_data];
-				}
+				DFGNode* InitNode = get_data_node(dep->getInit());
 				auto InitEdge = new InitDataEdge(*self, i);
 				assert(G->connect(*InitNode, *self, *InitEdge) && "Trying to connect non-exist nodes");
 			} else {
@@ -610,9 +954,12 @@ void DFGPassHandler::createDataFlowGraph(Function &F, Loop &L, FunctionAnalysisM
 	}
 
 	// make connection for induction variables
+	// if they are mapped to loop counters, remaining step instructions
+	// are connected as normal nodes
 	for (auto item : idv_phis) {
 		auto phi = item.first;
 		auto dep = item.second;
+		if (counter_phis.contains(phi)) continue;
 		connect_to_loop_dep_node(dep, phi);
 		kernel_inst.erase(dep->getDefInst());
 	}
@@ -702,14 +1049,35 @@ void DFGPassHandler::createDataFlowGraph(Function &F, Loop &L, FunctionAnalysisM
 			DFGEdge *NewEdge;
 			if (is_memdep(operand)) {
 				// connect mem load for init edges
+				DFGNode* LoadNode = value_to_node[operand];
 				auto InitEdge = new InitDataEdge(*dst, i);
-				G->connect(*(value_to_node[operand]), *dst, *InitEdge);
+				G->connect(*LoadNode, *dst, *InitEdge);
 
 				// connect to def node instead of memory load
 				auto memdep = memdep_map[operand];
 				operand = memdep->getDef();
-				NewEdge = new LoopDependencyEdge(*dst, i, memdep->getDistance());
-				
+				int distance = memdep->getDistance();
+				if (distance > 1 && is_node_exist(operand) &&
+						model->getDelayLineStyle() ==
+						CGRAModel::DelayLineStyle::RegisterChain) {
+					// insert delay registers so that each back-edge has distance 1
+					DFGNode* prev = value_to_node[operand];
+					for (int stage = 1; stage < distance; stage++) {
+						DFGNode* delay = make_delay_node(operand,
+												make_unique_id(), stage);
+						delay = G->addNode(*delay);
+						auto DelayEdge = new LoopDependencyEdge(*delay, 0, 1);
+						assert(G->connect(*prev, *delay, *DelayEdge) && "Trying to connect non-exist nodes");
+						// the register holds loaded data until the chain is filled
+						auto DelayInitEdge = new InitDataEdge(*delay, 0);
+						G->connect(*LoadNode, *delay, *DelayInitEdge);
+						prev = delay;
+					}
+					NewEdge = new LoopDependencyEdge(*dst, i, 1);
+					assert(G->connect(*prev, *dst, *NewEdge) && "Trying to connect non-exist nodes");
+					continue;
+				}
+				NewEdge = new LoopDependencyEdge(*dst, i, distance);
 
 			} else {
 				NewEdge = new DFGEdge(*dst, i);
@@ -0,0 +1,432 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /src/Passes/CGRAOmpDFGPass/KernelFusion.cpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 04:43:08
+*    Last Modified: 17-10-2026 04:43:08
+*/
+#include "common.hpp"
+#include "KernelFusion.hpp"
+#include "CGRAOmpPass.hpp"
+#include "CGRAModel.hpp"
+#include "VerifyPass.hpp"
+#include "AGVerifyPass.hpp"
+#include "CGRADataFlowGraph.hpp"
+#include "DataTransferPlan.hpp"
+#include "OptionPlugin.hpp"
+#include "Utils.hpp"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/SourceMgr.h"
+
+#include <map>
+
+using namespace llvm;
+using namespace CGRAOmp;
+using namespace CGRAOmp::Utils;
+
+#define DEBUG_TYPE "cgraomp-kernel-fusion"
+
+/* prefix of the arrays passing the arguments to __tgt_target* runtime calls */
+#define OFFLOAD_ARGS_PREFIX	".offload_"
+
+namespace {
+	/// a memory access of a kernel loop
+	struct AccessInfo {
+		Instruction *I;
+		std::string symbol;
+		AffineAGCompatibility::ConfigTy C;
+		Type *type;
+	};
+}
+
+/**
+ * @brief collect trip counts of a loop nest from the outermost
+ * @return false if any of them is not constant or the nest is not perfect
+ */
+static bool getTripCounts(Loop *L, ScalarEvolution &SE,
+							SmallVectorImpl<unsigned> &counts)
+{
+	while (L) {
+		unsigned tc = SE.getSmallConstantTripCount(L);
+		if (tc == 0) return false;
+		counts.push_back(tc);
+		auto &sub = L->getSubLoops();
+		if (sub.size() > 1) return false;
+		L = sub.empty() ? nullptr : sub.front();
+	}
+	return true;
+}
+
+/**
+ * @brief collect memory accesses to the arrays shared with the host
+ * @return false if any of them is not analyzable
+ */
+static bool collectAccesses(Loop &L, LoopStandardAnalysisResults &AR,
+							SmallVectorImpl<AccessInfo> &loads,
+							SmallVectorImpl<AccessInfo> &stores)
+{
+	auto &SE = AR.SE;
+	for (auto BB : L.blocks()) {
+		for (auto &I : *BB) {
+			Value *addr;
+			Type *type;
+			if (auto load = dyn_cast<LoadInst>(&I)) {
+				addr = load->getPointerOperand();
+				type = load->getType();
+				// base address of an array
+				if (type->isPointerTy() && L.isLoopInvariant(addr)) continue;
+			} else if (auto store = dyn_cast<StoreInst>(&I)) {
+				addr = store->getPointerOperand();
+				type = store->getValueOperand()->getType();
+			} else if (I.mayWriteToMemory()) {
+				LLVM_DEBUG(dbgs() << WARN_DEBUG_PREFIX << "unknown memory side effect: "
+							<< I << "\n");
+				return false;
+			} else {
+				continue;
+			}
+			// private variables are not shared among kernels
+			if (isa<AllocaInst>(getUnderlyingObject(addr))) continue;
+
+			AccessInfo A = {&I, MemAccessNode::getSymbolOf(addr), {}, type};
+			if (A.symbol == "unknown" || !SE.isSCEVable(addr->getType())) {
+				return false;
+			}
+			verifySCEVAsAffineAG(SE.getSCEV(addr), AR, A.C);
+			if (!A.C.valid) return false;
+
+			if (isa<LoadInst>(I)) {
+				loads.emplace_back(std::move(A));
+			} else {
+				stores.emplace_back(std::move(A));
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief find the launch of a target region in the host module
+ * @return CallBase* the __tgt_target* call, or nullptr if it is not launched exactly once
+ */
+static CallBase* findLaunch(Module &HostM, StringRef offload_name)
+{
+	auto region_id = HostM.getNamedGlobal(
+						("." + offload_name + REGION_ID_SUFFIX).str());
+	if (!region_id) return nullptr;
+	CallBase *launch = nullptr;
+	for (auto &F : HostM) {
+		for (auto &I : instructions(F)) {
+			auto call = dyn_cast<CallBase>(&I);
+			if (!call || !call->getCalledFunction() ||
+					!call->getCalledFunction()->getName().startswith("__tgt_target")) {
+				continue;
+			}
+			if (any_of(call->args(), [&](Value *arg) {
+					return arg->stripPointerCasts() == region_id;
+				})) {
+				if (launch) return nullptr;
+				launch = call;
+			}
+		}
+	}
+	return launch;
+}
+
+/// check if a host instruction has any effect visible to the kernels
+static bool hasHostSideEffect(Instruction &I)
+{
+	if (!I.mayWriteToMemory() && !I.mayThrow()) return false;
+	if (auto call = dyn_cast<CallBase>(&I)) {
+		if (isa<DbgInfoIntrinsic>(call) || call->isLifetimeStartOrEnd()) {
+			return false;
+		}
+		// trip count given to the next launch
+		auto callee = call->getCalledFunction();
+		return !(callee &&
+				callee->getName().startswith("__kmpc_push_target_tripcount"));
+	}
+	if (auto store = dyn_cast<StoreInst>(&I)) {
+		// arguments of the next launch
+		auto obj = getUnderlyingObject(store->getPointerOperand());
+		if (auto alloca = dyn_cast<AllocaInst>(obj)) {
+			auto name = alloca->getName();
+			return !(name.startswith(OFFLOAD_ARGS_PREFIX) ||
+						name.endswith(".casted"));
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief check if the host does nothing between two launches
+ * @details The path from the first launch is followed assuming the offloading succeeds,
+ * i.e., the branch to the host fallback is ignored.
+ * Only the preparation of the arguments for the second launch is allowed on the path.
+ * 
+ * @param first launch of the producer
+ * @param second launch of the consumer
+ * @param fallback name of the host fallback of the producer
+ */
+static bool isConsecutiveLaunch(CallBase *first, CallBase *second,
+								StringRef fallback)
+{
+	auto calls_fallback = [&](BasicBlock *BB) {
+		return any_of(*BB, [&](Instruction &I) {
+			auto call = dyn_cast<CallBase>(&I);
+			return call && call->getCalledFunction() &&
+					call->getCalledFunction()->getName() == fallback;
+		});
+	};
+
+	SmallPtrSet<BasicBlock*, 8> visited;
+	Instruction *I = first->getNextNode();
+	while (I) {
+		if (I == second) return true;
+		if (auto br = dyn_cast<BranchInst>(I)) {
+			BasicBlock *next = nullptr;
+			for (auto succ : successors(br->getParent())) {
+				if (calls_fallback(succ)) continue;
+				if (next) return false;
+				next = succ;
+			}
+			if (!next || !visited.insert(next).second) return false;
+			I = &next->front();
+			continue;
+		}
+		if (I->isTerminator() || hasHostSideEffect(*I)) {
+			LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << "host code between the launches: "
+						<< *I << "\n");
+			return false;
+		}
+		I = I->getNextNode();
+	}
+	return false;
+}
+
+/// check if two accesses visit the same elements in the same order
+static bool isSameAccessPattern(const AccessInfo &A, const AccessInfo &B)
+{
+	if (A.symbol != B.symbol || A.type != B.type) return false;
+	if (A.C.config.size() != B.C.config.size()) return false;
+	for (auto it : zip(A.C.config, B.C.config)) {
+		auto &X = std::get<0>(it);
+		auto &Y = std::get<1>(it);
+		if (X.start != Y.start || X.step != Y.step || X.count != Y.count) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* ================= Implementation of KernelFusionAnalysisPass ================= */
+AnalysisKey KernelFusionAnalysisPass::Key;
+
+KernelFusionAnalysisPass::Result
+KernelFusionAnalysisPass::run(Module &M, ModuleAnalysisManager &AM)
+{
+	Result result;
+
+	auto &MM = AM.getResult<ModelManagerPass>(M);
+	auto model = MM.getModel();
+	auto &kernel_info = AM.getResult<OmpKernelAnalysisPass>(M);
+	auto &FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+
+	// target regions of each host function sorted by the line
+	StringMap<std::map<int, SmallVector<Function*>>> regions;
+	for (auto &md : kernel_info.metadata()) {
+		if (md.metadata_kind == 0) {
+			regions[md.func_name][md.line];
+		}
+	}
+	for (auto F : kernel_info.kernels()) {
+		auto md = kernel_info.getMetadata(kernel_info.getOffloadFunction(F));
+		if (md != kernel_info.md_end()) {
+			regions[md->func_name][md->line].push_back(F);
+		}
+	}
+
+	// the launches are checked in the host code
+	LLVMContext HostCtx;
+	std::unique_ptr<Module> HostM;
+	if (OptFusionHostIR != "") {
+		SMDiagnostic Err;
+		HostM = parseIRFile(OptFusionHostIR, Err, HostCtx);
+		if (!HostM) {
+			errs() << formatv(WARN_MSG_PREFIX "cannot read the host IR {0}: {1}\n",
+								OptFusionHostIR, Err.getMessage());
+		}
+	}
+	if (!HostM) {
+		LLVM_DEBUG(dbgs() << WARN_DEBUG_PREFIX
+			<< "kernels are not fused without the host IR\n");
+		return result;
+	}
+	auto is_consecutive = [&](Function *producer, Function *consumer) {
+		auto first_name = kernel_info.getOffloadFunction(producer)->getName();
+		auto second_name = kernel_info.getOffloadFunction(consumer)->getName();
+		auto first = findLaunch(*HostM, first_name);
+		auto second = findLaunch(*HostM, second_name);
+		return first && second &&
+				first->getFunction() == second->getFunction() &&
+				isConsecutiveLaunch(first, second, first_name);
+	};
+
+	auto get_loop = [&](Function *F) -> Loop* {
+		switch (model->getKind()) {
+			case CGRAModel::CGRACategory::Decoupled:
+				return getKernelLoop<DecoupledVerifyPass>(*F, FAM);
+			case CGRAModel::CGRACategory::TimeMultiplexed:
+				return getKernelLoop<TimeMultiplexedVerifyPass>(*F, FAM);
+		}
+		return nullptr;
+	};
+
+	SmallPtrSet<Function*, 8> fused;
+	for (auto &entry : regions) {
+		auto &list = entry.second;
+		for (auto it = list.begin(); it != list.end(); it++) {
+			auto next = std::next(it);
+			if (next == list.end()) break;
+			// one kernel per target region
+			if (it->second.size() != 1 || next->second.size() != 1) continue;
+			FusionCandidate C;
+			C.producer = it->second.front();
+			C.consumer = next->second.front();
+			if (fused.count(C.producer)) continue;
+			if (!is_consecutive(C.producer, C.consumer)) {
+				LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << formatv(
+					"{0} and {1} are not launched consecutively\n",
+					C.producer->getName(), C.consumer->getName()));
+				continue;
+			}
+			C.producer_loop = get_loop(C.producer);
+			C.consumer_loop = get_loop(C.consumer);
+			if (!C.producer_loop || !C.consumer_loop) continue;
+
+			if (isFusible(C, FAM)) {
+				LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << formatv(
+					"{0} (line {1}) and {2} (line {3}) in {4} can be fused\n",
+					C.producer->getName(), it->first, C.consumer->getName(),
+					next->first, entry.getKey()));
+				fused.insert(C.producer);
+				fused.insert(C.consumer);
+				result.add_candidate(std::move(C));
+			}
+		}
+	}
+
+	return result;
+}
+
+template <typename VerifyPassT>
+Loop* KernelFusionAnalysisPass::getKernelLoop(Function &F,
+											FunctionAnalysisManager &FAM)
+{
+	VerifyResult &R = FAM.getResult<VerifyPassT>(F);
+	if (R.getNumKernels() != 1) {
+		return nullptr;
+	}
+	return *(R.kernel_begin());
+}
+
+bool KernelFusionAnalysisPass::isFusible(FusionCandidate &C,
+										FunctionAnalysisManager &FAM)
+{
+	auto PAR = getLSAR(*C.producer, FAM);
+	auto CAR = getLSAR(*C.consumer, FAM);
+
+	// compatible iteration spaces
+	SmallVector<unsigned> producer_tc, consumer_tc;
+	if (!getTripCounts(C.producer_loop, PAR.SE, producer_tc) ||
+			!getTripCounts(C.consumer_loop, CAR.SE, consumer_tc) ||
+			producer_tc != consumer_tc) {
+		LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << formatv(
+			"iteration spaces of {0} and {1} are not compatible\n",
+			C.producer->getName(), C.consumer->getName()));
+		return false;
+	}
+
+	SmallVector<AccessInfo> producer_loads, producer_stores;
+	SmallVector<AccessInfo> consumer_loads, consumer_stores;
+	if (!collectAccesses(*C.producer_loop, PAR, producer_loads, producer_stores) ||
+			!collectAccesses(*C.consumer_loop, CAR, consumer_loads, consumer_stores)) {
+		LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << formatv(
+			"memory accesses of {0} or {1} are not analyzable\n",
+			C.producer->getName(), C.consumer->getName()));
+		return false;
+	}
+
+	StringMap<SmallVector<AccessInfo*>> written;
+	StringSet<> read;
+	for (auto &A : producer_stores) {
+		written[A.symbol].push_back(&A);
+	}
+	for (auto &A : producer_loads) {
+		read.insert(A.symbol);
+	}
+
+	// the consumer must not overwrite data used by the producer
+	for (auto &A : consumer_stores) {
+		if (written.count(A.symbol) || read.count(A.symbol)) {
+			LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << formatv(
+				"{0} overwrites {1} accessed by {2}\n", C.consumer->getName(),
+				A.symbol, C.producer->getName()));
+			return false;
+		}
+	}
+
+	// producer-consumer relationship
+	for (auto &A : consumer_loads) {
+		auto it = written.find(A.symbol);
+		if (it == written.end()) continue;
+		auto &stores = it->second;
+		if (stores.size() != 1 || !isSameAccessPattern(*stores.front(), A)) {
+			LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << formatv(
+				"{0} of {1} cannot be forwarded from {2}\n", A.symbol,
+				C.consumer->getName(), C.producer->getName()));
+			return false;
+		}
+		C.forward[cast<LoadInst>(A.I)] = cast<StoreInst>(stores.front()->I);
+		if (!is_contained(C.shared, A.symbol)) {
+			C.shared.push_back(A.symbol);
+		}
+	}
+
+	return !C.forward.empty();
+}
@@ -0,0 +1,121 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /src/Passes/CGRAOmpDFGPass/LineBufferReuse.cpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 04:24:38
+*    Last Modified: 17-10-2026 04:24:38
+*/
+#include "common.hpp"
+#include "DFGPass.hpp"
+#include "CGRAOmpPass.hpp"
+#include "LineBufferReuse.hpp"
+#include "SlidingWindowAnalysis.hpp"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Debug.h"
+
+#include <algorithm>
+
+using namespace llvm;
+using namespace CGRAOmp;
+
+#define DEBUG_TYPE "line-buffer"
+static const char *VerboseDebug = DEBUG_TYPE "-verbose";
+
+bool LineBufferReuse::run(CGRADFG &G, Loop &L, FunctionAnalysisManager &FAM,
+									LoopAnalysisManager &LAM,
+									LoopStandardAnalysisResults &AR)
+{
+	auto &MM = FAM.getResult<ModelManagerFunctionProxy>(*G.getFunction());
+	auto dec_model = dyn_cast<DecoupledCGRA>(MM.getModel());
+	if (!dec_model || !isa<AffineAG>(dec_model->getAG())) {
+		LLVM_DEBUG(dbgs() << WARN_DEBUG_PREFIX << name() 
+					<< " is only for decoupled CGRAs with affine AGs\n");
+		return false;
+	}
+
+	LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << "Running line buffer reuse for "
+				<< G.getName() << "\n");
+
+	auto &SW = LAM.getResult<SlidingWindowAnalysisPass>(L, AR);
+
+	// find load nodes
+	DenseMap<Value*, DFGNode*> load_nodes;
+	for (auto *N : G) {
+		if (auto mem = dyn_cast<MemAccessNode>(N)) {
+			if (mem->isLoad()) {
+				load_nodes[mem->getValue()] = mem;
+			}
+		}
+	}
+
+	bool changed = false;
+	for (auto &RG : SW.groups()) {
+		auto leader = load_nodes.find(RG.getLeader());
+		if (leader == load_nodes.end()) continue;
+		DFGNode *Leader = leader->second;
+
+		// extend the stream for the line buffer
+		Leader->setExtraInfo("AGConfig",
+			AffineAGCompatibility::configToJson(RG.getStreamConfig()));
+		Leader->setExtraInfo("LineBuffer", json::Object(
+			{{"depth", json::Value(RG.getDepth())},
+			 {"row_extension", json::Value(RG.getRowExtension())},
+			 {"warmup", json::Value(RG.getWarmup())}}
+		));
+
+		// make a chain of shift registers in order of the delay
+		SmallVector<ReuseGroup::TapTy> taps(RG.getTaps().begin(),
+											RG.getTaps().end());
+		std::sort(taps.begin(), taps.end(), [](auto lhs, auto rhs) {
+			return lhs.second < rhs.second;
+		});
+		DFGNode *prev = Leader;
+		int prev_delay = 0;
+		for (auto tap : taps) {
+			auto found = load_nodes.find(tap.first);
+			if (found == load_nodes.end()) continue;
+			DFGNode *Tap = found->second;
+			int depth = tap.second - prev_delay;
+			if (depth > 0) {
+				DFGNode *SR = new ShiftRegisterNode(tap.first, depth);
+				SR = G.addNode(*SR);
+				G.connect(*prev, *SR, *(new DFGEdge(*SR, 0)));
+				prev = SR;
+				prev_delay = tap.second;
+			}
+			DEBUG_WITH_TYPE(VerboseDebug, dbgs() << DBG_DEBUG_PREFIX
+				<< formatv("replacing {0} with {1}\n",
+					Tap->getUniqueName(), prev->getUniqueName()));
+			G.replaceAllUsesWith(*Tap, *prev);
+			G.removeNodeAndDeadOperands(*Tap);
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+#undef DEBUG_TYPE
@@ -0,0 +1,144 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /src/Passes/CGRAOmpDFGPass/MemoryAccessOpt.cpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 10:12:31
+*    Last Modified: 17-10-2026 10:12:31
+*/
+#include "common.hpp"
+#include "DFGPass.hpp"
+#include "CGRAOmpPass.hpp"
+#include "MemoryAccessOpt.hpp"
+#include "Utils.hpp"
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/MemoryLocation.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Debug.h"
+
+using namespace llvm;
+using namespace CGRAOmp;
+using namespace CGRAOmp::Utils;
+
+#define DEBUG_TYPE "mem-access-opt"
+static const char *VerboseDebug = DEBUG_TYPE "-verbose";
+
+bool MemoryAccessOpt::run(CGRADFG &G, Loop &L, FunctionAnalysisManager &FAM,
+									LoopAnalysisManager &LAM,
+									LoopStandardAnalysisResults &AR)
+{
+	auto &MM = FAM.getResult<ModelManagerFunctionProxy>(*G.getFunction());
+	if (!isa<TMCGRA>(*MM.getModel())) {
+		LLVM_DEBUG(dbgs() << WARN_DEBUG_PREFIX << name() 
+					<< " is only for time-multiplexed CGRAs\n");
+		return false;
+	}
+
+	LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << "Running memory access optimization for "
+				<< G.getName() << "\n");
+
+	// collect memory access nodes
+	SmallVector<DFGNode*> loads, stores;
+	for (auto *N : G) {
+		if (*N == G.getRoot()) continue;
+		if (!isa<ComputeNode>(*N) && !isa<MemAccessNode>(*N)) continue;
+		if (isa_and_nonnull<LoadInst>(N->getValue())) {
+			loads.push_back(N);
+		} else if (isa_and_nonnull<StoreInst>(N->getValue())) {
+			stores.push_back(N);
+		}
+	}
+
+	bool changed = false;
+	SmallPtrSet<DFGNode*, 16> removed;
+
+	// store-to-load forwarding
+	for (auto LoadNode : loads) {
+		auto load = cast<LoadInst>(LoadNode->getValue());
+		// skip loads carrying data over iterations
+		if (any_of(LoadNode->getEdges(), [](DFGEdge *E) {
+				return E->getKind() != DFGEdge::EdgeKind::Normal;
+			})) {
+			continue;
+		}
+		for (auto StoreNode : stores) {
+			auto store = cast<StoreInst>(StoreNode->getValue());
+			if (store->getValueOperand()->getType() != load->getType()) continue;
+			if (!AR.DT.dominates(store, load)) continue;
+			if (!isSameAddress(store, load, AR.SE)) continue;
+			if (isAccessedBetween(store, load, MemoryLocation::get(load), L, AR)) continue;
+			if (auto Stored = G.findOperandNode(*StoreNode, 0)) {
+				DEBUG_WITH_TYPE(VerboseDebug, dbgs() << DBG_DEBUG_PREFIX
+					<< formatv("forwarding {0} to {1}\n",
+						Stored->getUniqueName(), LoadNode->getUniqueName()));
+				G.replaceAllUsesWith(*LoadNode, *Stored);
+				G.removeNodeAndDeadOperands(*LoadNode);
+				removed.insert(LoadNode);
+				changed = true;
+				break;
+			}
+		}
+	}
+
+	// redundant load elimination
+	for (auto LoadA : loads) {
+		if (removed.contains(LoadA)) continue;
+		auto loadA = cast<LoadInst>(LoadA->getValue());
+		for (auto LoadB : loads) {
+			if (LoadA == LoadB || removed.contains(LoadB)) continue;
+			auto loadB = cast<LoadInst>(LoadB->getValue());
+			if (loadA->getType() != loadB->getType()) continue;
+			if (!AR.DT.dominates(loadA, loadB)) continue;
+			if (!isSameAddress(loadA, loadB, AR.SE)) continue;
+			if (isAccessedBetween(loadA, loadB, MemoryLocation::get(loadA), L, AR)) continue;
+			DEBUG_WITH_TYPE(VerboseDebug, dbgs() << DBG_DEBUG_PREFIX
+				<< formatv("merging {0} into {1}\n",
+					LoadB->getUniqueName(), LoadA->getUniqueName()));
+			G.replaceAllUsesWith(*LoadB, *LoadA);
+			G.removeNodeAndDeadOperands(*LoadB);
+			removed.insert(LoadB);
+			changed = true;
+		}
+	}
+
+	LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << removed.size()
+				<< " loads are eliminated\n");
+
+	return changed;
+}
+
+bool MemoryAccessOpt::isSameAddress(Instruction *A, Instruction *B,
+									ScalarEvolution &SE)
+{
+	auto APtr = getLoadStorePointerOperand(A);
+	auto BPtr = getLoadStorePointerOperand(B);
+	if (!APtr || !BPtr) return false;
+	return SE.getSCEV(APtr) == SE.getSCEV(BPtr);
+}
+
+#undef DEBUG_TYPE
@@ -0,0 +1,352 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /src/Passes/CGRAOmpDFGPass/WideMemoryAccess.cpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 04:30:13
+*    Last Modified: 17-10-2026 04:30:13
+*/
+#include "common.hpp"
+#include "DFGPass.hpp"
+#include "CGRAOmpPass.hpp"
+#include "WideMemoryAccess.hpp"
+#include "CGRAModel.hpp"
+#include "AGVerifyPass.hpp"
+#include "Utils.hpp"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Analysis/MemoryLocation.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Debug.h"
+
+#include <algorithm>
+
+using namespace llvm;
+using namespace CGRAOmp;
+using namespace CGRAOmp::Utils;
+
+#define DEBUG_TYPE "wide-mem-access"
+static const char *VerboseDebug = DEBUG_TYPE "-verbose";
+
+/// get the type of data loaded or stored
+static Type* getAccessType(Instruction *I)
+{
+	if (auto store = dyn_cast<StoreInst>(I)) {
+		return store->getValueOperand()->getType();
+	}
+	return I->getType();
+}
+
+bool WideMemoryAccess::run(CGRADFG &G, Loop &L, FunctionAnalysisManager &FAM,
+									LoopAnalysisManager &LAM,
+									LoopStandardAnalysisResults &AR)
+{
+	auto &MM = FAM.getResult<ModelManagerFunctionProxy>(*G.getFunction());
+	int max_width = MM.getModel()->getMaxMemAccessWidth();
+	if (max_width == 0) {
+		LLVM_DEBUG(dbgs() << WARN_DEBUG_PREFIX << name() 
+					<< " is skipped because the CGRA supports only scalar accesses\n");
+		return false;
+	}
+	// the AGs of decoupled CGRAs must generate the addresses of the wide accesses
+	bool is_decoupled = false;
+	if (auto dec_model = dyn_cast<DecoupledCGRA>(MM.getModel())) {
+		if (!isa<AffineAG>(dec_model->getAG())) {
+			LLVM_DEBUG(dbgs() << WARN_DEBUG_PREFIX << name()
+						<< " is skipped because the AG config of wide accesses is available only for affine AGs\n");
+			return false;
+		}
+		is_decoupled = true;
+	}
+
+	LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << "Running wide memory access merging for "
+				<< G.getName() << "\n");
+
+	// collect memory access nodes
+	SmallVector<DFGNode*> loads, stores;
+	for (auto *N : G) {
+		if (*N == G.getRoot()) continue;
+		if (!isa<ComputeNode>(*N) && !isa<MemAccessNode>(*N)) continue;
+		if (auto load = dyn_cast_or_null<LoadInst>(N->getValue())) {
+			if (load->isSimple()) loads.push_back(N);
+		} else if (auto store = dyn_cast_or_null<StoreInst>(N->getValue())) {
+			if (store->isSimple()) stores.push_back(N);
+		}
+	}
+
+	bool changed = false;
+	auto merge_groups = [&](ArrayRef<DFGNode*> accesses, bool is_load) {
+		SmallVector<SmallVector<LaneTy>> groups;
+		groupAdjacent(accesses, AR.SE, groups);
+		for (auto &group : groups) {
+			auto leader = cast<Instruction>(group.front().first->getValue());
+			int lane_width = getDataWidth(getAccessType(leader));
+			int max_lanes = max_width / lane_width;
+			if (max_lanes < 2) continue;
+
+			// split into runs of consecutive elements
+			SmallVector<LaneTy> run;
+			auto flush = [&]() {
+				if (run.size() >= 2 && isMergeable(run, G, L, AR)) {
+					Optional<json::Value> ag_config;
+					if (is_decoupled) {
+						ag_config = getWideAGConfig(run, lane_width, AR);
+					}
+					if (is_decoupled && !ag_config) {
+						DEBUG_WITH_TYPE(VerboseDebug, dbgs() << DBG_DEBUG_PREFIX
+							<< formatv("accesses from {0} are not a single affine stream\n",
+								run.front().first->getUniqueName()));
+					} else {
+						DEBUG_WITH_TYPE(VerboseDebug, dbgs() << DBG_DEBUG_PREFIX
+							<< formatv("merging {0} accesses from {1}\n",
+								run.size(), run.front().first->getUniqueName()));
+						if (is_load) {
+							mergeLoads(run, G, lane_width, ag_config);
+						} else {
+							mergeStores(run, G, lane_width, ag_config);
+						}
+						changed = true;
+					}
+				}
+				run.clear();
+			};
+			for (auto lane : group) {
+				if (!run.empty() && (lane.second != run.back().second + 1 ||
+										(int)run.size() == max_lanes)) {
+					flush();
+				}
+				run.push_back(lane);
+			}
+			flush();
+		}
+	};
+
+	merge_groups(loads, true);
+	merge_groups(stores, false);
+
+	return changed;
+}
+
+void WideMemoryAccess::groupAdjacent(ArrayRef<DFGNode*> accesses,
+							ScalarEvolution &SE,
+							SmallVectorImpl<SmallVector<LaneTy>> &groups)
+{
+	for (auto N : accesses) {
+		auto I = cast<Instruction>(N->getValue());
+		auto T = getAccessType(I);
+		int width = getDataWidth(T);
+		// only for byte-addressable scalar data
+		if (width == 0 || width % 8 != 0) continue;
+		auto Ptr = getLoadStorePointerOperand(I);
+		auto PtrSCEV = SE.getSCEV(Ptr);
+
+		bool grouped = false;
+		for (auto &group : groups) {
+			auto leader = cast<Instruction>(group.front().first->getValue());
+			auto LeaderPtr = getLoadStorePointerOperand(leader);
+			if (getAccessType(leader) != T ||
+					LeaderPtr->getType() != Ptr->getType() ||
+					leader->getParent() != I->getParent()) {
+				continue;
+			}
+			auto diff = dyn_cast<SCEVConstant>(
+							SE.getMinusSCEV(PtrSCEV, SE.getSCEV(LeaderPtr)));
+			if (!diff) continue;
+			int64_t bytes = diff->getAPInt().getSExtValue();
+			if (bytes % (width / 8) != 0) continue;
+			group.push_back(std::make_pair(N, bytes / (width / 8)));
+			grouped = true;
+			break;
+		}
+		if (!grouped) {
+			groups.push_back(SmallVector<LaneTy>({std::make_pair(N, 0)}));
+		}
+	}
+
+	for (auto &group : groups) {
+		std::stable_sort(group.begin(), group.end(), [](auto lhs, auto rhs) {
+			return lhs.second < rhs.second;
+		});
+	}
+}
+
+bool WideMemoryAccess::isMergeable(ArrayRef<LaneTy> run, CGRADFG &G, Loop &L,
+									LoopStandardAnalysisResults &AR)
+{
+	SmallVector<Instruction*> insts;
+	for (auto lane : run) {
+		DFGNode *N = lane.first;
+		// already removed as a dead operand
+		if (!is_contained(G, N)) return false;
+		// skip accesses carrying data over iterations
+		if (any_of(N->getEdges(), [](DFGEdge *E) {
+				return E->getKind() != DFGEdge::EdgeKind::Normal;
+			})) {
+			return false;
+		}
+		SmallVector<CGRADFG::EdgeInfoType> in_edges;
+		G.findIncomingEdgesToNode(*N, in_edges, true);
+		for (auto EI : in_edges) {
+			if (any_of(EI.second, [](DFGEdge *E) {
+					return E->getKind() != DFGEdge::EdgeKind::Normal;
+				})) {
+				return false;
+			}
+		}
+		if (isa<StoreInst>(N->getValue()) && !G.findOperandNode(*N, 0)) {
+			return false;
+		}
+		insts.push_back(cast<Instruction>(N->getValue()));
+	}
+
+	// the accesses are in the same basic block
+	auto first = *std::min_element(insts.begin(), insts.end(),
+						[](auto lhs, auto rhs) { return lhs->comesBefore(rhs); });
+	auto last = *std::max_element(insts.begin(), insts.end(),
+						[](auto lhs, auto rhs) { return lhs->comesBefore(rhs); });
+	bool is_store = isa<StoreInst>(first);
+	for (auto I : insts) {
+		if (isAccessedBetween(first, last, MemoryLocation::get(I), L, AR,
+								is_store, insts)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @details The wide access is issued at the address of the leader in every iteration,
+ * so the steps and the counts of the leader are kept and the lanes and their width are added.
+ * The other lanes must have the same base, steps and counts as the leader
+ * with the start shifted by their offsets.
+ */
+Optional<json::Value> WideMemoryAccess::getWideAGConfig(ArrayRef<LaneTy> run,
+									int lane_width, LoopStandardAnalysisResults &AR)
+{
+	auto get_config = [&](DFGNode *N) {
+		AffineAGCompatibility::ConfigTy C;
+		auto I = cast<Instruction>(N->getValue());
+		verifySCEVAsAffineAG(AR.SE.getSCEV(getLoadStorePointerOperand(I)), AR, C);
+		return C;
+	};
+	auto get_start = [](AffineAGCompatibility::ConfigTy &C) {
+		int64_t start = 0;
+		for (auto &entry : C.config) {
+			start += entry.start;
+		}
+		return start;
+	};
+
+	auto leader = get_config(run.front().first);
+	if (!leader.valid || leader.config.empty()) return None;
+	for (auto lane : run.drop_front()) {
+		auto C = get_config(lane.first);
+		if (!C.valid || C.base != leader.base ||
+				C.config.size() != leader.config.size()) {
+			return None;
+		}
+		for (unsigned i = 0; i < C.config.size(); i++) {
+			if (C.config[i].step != leader.config[i].step ||
+					C.config[i].count != leader.config[i].count) {
+				return None;
+			}
+		}
+		int64_t offset = (lane.second - run.front().second) * (lane_width / 8);
+		if (get_start(C) - get_start(leader) != offset) return None;
+	}
+
+	auto config = AffineAGCompatibility::configToJson(leader);
+	auto obj = config.getAsObject();
+	(*obj)["lanes"] = json::Value((int64_t)run.size());
+	(*obj)["width"] = json::Value(lane_width);
+	return config;
+}
+
+DFGNode* WideMemoryAccess::createWideNode(DFGNode *Leader, int lanes,
+											int lane_width, CGRADFG &G,
+											Optional<json::Value> &ag_config)
+{
+	auto leader = cast<Instruction>(Leader->getValue());
+	std::string symbol = "";
+	if (auto mem = dyn_cast<MemAccessNode>(Leader)) {
+		symbol = mem->getSymbol();
+	}
+	DFGNode *Wide = new WideMemAccessNode(leader, lanes, lane_width, symbol);
+	Wide = G.addNode(*Wide);
+	// inherit memory bank etc.
+	Wide->copyExtraInfo(*Leader);
+	if (ag_config) {
+		Wide->setExtraInfo("AGConfig", *ag_config);
+	}
+
+	// inherit the address of the leader
+	int addr_operand = isa<LoadInst>(leader) ? 0 : 1;
+	if (auto Addr = G.findOperandNode(*Leader, addr_operand)) {
+		G.connect(*Addr, *Wide, *(new DFGEdge(*Wide, addr_operand)));
+	}
+	return Wide;
+}
+
+void WideMemoryAccess::mergeLoads(ArrayRef<LaneTy> run, CGRADFG &G,
+									int lane_width, Optional<json::Value> &ag_config)
+{
+	DFGNode *Wide = createWideNode(run.front().first, run.size(), lane_width, G,
+									ag_config);
+	for (auto lane : enumerate(run)) {
+		DFGNode *Load = lane.value().first;
+		DFGNode *Extract = new SubWordNode(Load->getValue(), true, lane.index());
+		Extract = G.addNode(*Extract);
+		G.connect(*Wide, *Extract, *(new DFGEdge(*Extract, 0)));
+		G.replaceAllUsesWith(*Load, *Extract);
+		G.removeNodeAndDeadOperands(*Load);
+	}
+}
+
+void WideMemoryAccess::mergeStores(ArrayRef<LaneTy> run, CGRADFG &G,
+									int lane_width, Optional<json::Value> &ag_config)
+{
+	DFGNode *Wide = createWideNode(run.front().first, run.size(), lane_width, G,
+									ag_config);
+	// pack the stored data
+	DFGNode *Packed = nullptr;
+	for (auto lane : enumerate(run)) {
+		DFGNode *Store = lane.value().first;
+		DFGNode *Data = G.findOperandNode(*Store, 0);
+		DFGNode *Insert = new SubWordNode(Store->getValue(), false, lane.index());
+		Insert = G.addNode(*Insert);
+		G.connect(*Data, *Insert, *(new DFGEdge(*Insert, 0)));
+		if (Packed) {
+			G.connect(*Packed, *Insert, *(new DFGEdge(*Insert, 1)));
+		}
+		Packed = Insert;
+	}
+	G.connect(*Packed, *Wide, *(new DFGEdge(*Wide, 0)));
+
+	for (auto lane : run) {
+		G.removeNodeAndDeadOperands(*lane.first);
+	}
+}
+
+#undef DEBUG_TYPE
@@ -34,12 +34,19 @@
 #include "OptionPlugin.hpp"
 #include "CGRAOmpAnnotationPass.hpp"
 #include "DFGPass.hpp"
+#include "DataTransferPlan.hpp"
+#include "KernelFusion.hpp"
+#include "KernelVersioning.hpp"
+#include "KernelHint.hpp"
 
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Transforms/Scalar/LoopPassManager.h"
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Analysis/MemorySSA.h"
 #include "llvm/Transforms/Utils/Mem2Reg.h"
 #include "llvm/Transforms/Utils/LoopSimplify.h"
@@ -47,8 +54,23 @@
 #include "llvm/Transforms/InstCombine/InstCombine.h"
 #include "llvm/Transforms/Scalar/SimplifyCFG.h"
 #include "llvm/Transforms/Scalar/LoopFlatten.h"
+#include "llvm/Transforms/Scalar/LoopUnrollPass.h"
+#include "llvm/Transforms/IPO/InferFunctionAttrs.h"
+#include "llvm/Transforms/IPO/ConstantMerge.h"
+#include "llvm/Transforms/Scalar/IndVarSimplify.h"
+#include "llvm/Transforms/Scalar/LoopIdiomRecognize.h"
+#include "llvm/Transforms/Scalar/LoopRotation.h"
+#include "llvm/Transforms/Scalar/LoopLoadElimination.h"
+#include "llvm/Transforms/Scalar/InstSimplifyPass.h"
+#include "llvm/Transforms/Scalar/EarlyCSE.h"
+#include "llvm/Transforms/Scalar/DCE.h"
+#include "llvm/Transforms/Scalar/GVN.h"
+#include "llvm/Transforms/Scalar/Reassociate.h"
+#include "llvm/Transforms/Scalar/MergedLoadStoreMotion.h"
+#include "llvm/Transforms/Scalar/TailRecursionElimination.h"
 
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringSet.h"
 
 #include <system_error>
 #include <type_traits>
@@ -62,6 +84,9 @@ static const char *VerboseDebug = DEBUG_TYPE "-verbose";
 
 // # of successfully exracted DFGs
 STATISTIC(num_dfg, "the number of extracted DFGs");
+// # of instructions classified by the instruction map
+STATISTIC(num_classified_inst, "the number of classified instructions");
+STATISTIC(num_supported_inst, "the number of instructions supported by the CGRA");
 
 
 /* ===================== Implementation of ModelManagerPass ===================== */
@@ -73,15 +98,62 @@ ModelManagerPass::run(Module &M, ModuleAnalysisManager &AM)
 	// for cache result
 	AM.getResult<ModuleAnnotationAnalysisPass>(M);
 
-	LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << "Instantiating CGRAModel\n");
-	auto ErrorOrModel = parseCGRASetting(PathToCGRAConfig, AM);
-	if (!ErrorOrModel) {
-		ExitOnError Exit(ERR_MSG_PREFIX);
-		Exit(std::move(ErrorOrModel.takeError()));
+	SmallVector<std::string> config_list(PathToCGRAConfig.begin(),
+											PathToCGRAConfig.end());
+	if (config_list.empty()) {
+		config_list.push_back("model.json");
+	}
+
+	SmallVector<CGRAModel*> models;
+	SmallVector<std::string> names;
+	StringSet<> used_names;
+	for (auto &config : config_list) {
+		LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << "Instantiating CGRAModel: "
+					<< config << "\n");
+		auto ErrorOrModel = parseCGRASetting(config, M, AM);
+		if (!ErrorOrModel) {
+			ExitOnError Exit(ERR_MSG_PREFIX);
+			Exit(std::move(ErrorOrModel.takeError()));
+		}
+		models.push_back(*ErrorOrModel);
+		// model name for the output directory
+		// a suffix is added until the name differs from all the previous ones
+		auto stem = sys::path::stem(config);
+		std::string name = stem.str();
+		for (int n = 1; used_names.count(name); n++) {
+			name = formatv("{0}_{1}", stem, n);
+		}
+		used_names.insert(name);
+		names.push_back(name);
 	}
-	auto model = *ErrorOrModel;
 
-	return ModelManager(model);
+	return ModelManager(models, names);
+}
+
+ModelManager::ModelManager(ArrayRef<CGRAModel*> CMs,
+							ArrayRef<std::string> names) :
+	state(std::make_shared<State>())
+{
+	assert(CMs.size() == names.size() && "a name is required for each model");
+	state->models.assign(CMs.begin(), CMs.end());
+	state->names.assign(names.begin(), names.end());
+	state->summaries.resize(CMs.size());
+}
+
+std::string ModelManager::getOutputPath(StringRef path) const
+{
+	if (!isMultiModel()) {
+		return path.str();
+	}
+	SmallString<128> dir(sys::path::parent_path(path));
+	sys::path::append(dir, getModelName());
+	if (auto EC = sys::fs::create_directories(dir)) {
+		ExitOnError Exit(ERR_MSG_PREFIX);
+		Exit(make_error<StringError>("Fail to create a directory "
+								+ dir.str() + ": " + EC.message(), EC));
+	}
+	sys::path::append(dir, sys::path::filename(path));
+	return dir.str().str();
 }
 
 template <typename IRUnitT, typename InvT>
@@ -119,6 +191,35 @@ ModelManagerLoopProxy::run(Loop &L, LoopAnalysisManager &AM,
 	return *MM;
 }
 
+/* ================= Implementation of InstMapAnalysisPass ================= */
+AnalysisKey InstMapAnalysisPass::Key;
+
+InstMapAnalysisPass::Result
+InstMapAnalysisPass::run(Function &F, FunctionAnalysisManager &AM)
+{
+	auto &MM = AM.getResult<ModelManagerFunctionProxy>(F);
+	auto *model = MM.getModel();
+
+	InstMapInfo result;
+	for (auto &I : instructions(F)) {
+		if (auto *imap = model->isSupported(&I)) {
+			result.insert(&I, imap);
+			++num_supported_inst;
+		}
+		++num_classified_inst;
+	}
+
+	return result;
+}
+
+bool InstMapInfo::invalidate(Function &F, const PreservedAnalyses &PA,
+								FunctionAnalysisManager::Invalidator &Inv)
+{
+	// the result refers to the instructions, so it is invalidated with the IR
+	auto PAC = PA.getChecker<InstMapAnalysisPass>();
+	return !(PAC.preserved() || PAC.preservedSet<AllAnalysesOn<Function>>());
+}
+
 
 /* ===================== Implementation of OmpKernelInfo ===================== */
 template <typename IRUnitT, typename InvT>
@@ -138,6 +239,7 @@ void OmpKernelInfo::setOffloadMetadata(Module &M)
 	raw_string_ostream OS(buf);
 
 	md_list.clear();
+	md_index.clear();
 
 	auto getMetadataInt = [&](Metadata* MD) -> int {
 		if (auto CM = dyn_cast<llvm::ConstantAsMetadata>(MD)){
@@ -180,24 +282,30 @@ void OmpKernelInfo::setOffloadMetadata(Module &M)
 		Exit(make_error<StringError>("omp_offload.info is not found", EC));
 	}
 
+	// index the entries by the name of the offloading function
+	// (the first entry is used if duplicated)
+	for (unsigned i = 0; i < md_list.size(); i++) {
+		auto &entry = md_list[i];
+		md_index.try_emplace(formatv(OUTLINED_FUNC_NAME_FMT, entry.file_dev_ID,
+						entry.file_ID, entry.func_name, entry.line).str(), i);
+	}
+
 }
 
 OmpKernelInfo::md_iterator OmpKernelInfo::getMetadata(Function *offload)
 {
-	md_iterator it;
-	for (it = md_begin(); it != md_end(); it++) {
-		auto entry = *it;
-		if (formatv(OUTLINED_FUNC_NAME_FMT, 
-			entry.file_dev_ID, entry.file_ID, entry.func_name, entry.line).str()
-			== offload->getName().str()) {
-				return it;
-		}
+	if (!offload) {
+		return md_end();
+	}
+	auto it = md_index.find(offload->getName());
+	if (it != md_index.end()) {
+		return md_begin() + it->second;
 	}
 	DEBUG_WITH_TYPE(VerboseDebug,
 		dbgs() << formatv("{0}Metadata for {1} is not found\n",
 		DBG_DEBUG_PREFIX, offload->getName()));
 
-	return it;
+	return md_end();
 }
 
 int OmpKernelInfo::getKernelLine(Function *kernel) {
@@ -344,6 +452,69 @@ RemoveScheduleRuntimePass::run(Module &M, ModuleAnalysisManager &AM)
 
 }
 
+/* ================ Implementation of SelectModelPass ================= */
+PreservedAnalyses SelectModelPass::run(Module &M, ModuleAnalysisManager &AM)
+{
+	auto &MM = AM.getResult<ModelManagerPass>(M);
+	if (MM.getSelectedIndex() == idx) {
+		return PreservedAnalyses::all();
+	}
+	MM.selectModel(idx);
+	LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << "Switching CGRA model to "
+				<< MM.getModelName() << "\n");
+
+	// the IR is not modified but the results depending on the model are dropped
+	PreservedAnalyses PA;
+	PA.preserve<ModelManagerPass>();
+	PA.preserve<OmpKernelAnalysisPass>();
+	PA.preserve<ModuleAnnotationAnalysisPass>();
+	PA.preserve<FunctionAnalysisManagerModuleProxy>();
+	// the schedule runtime is already removed so that it cannot be analyzed again
+	PA.preserve<OmpStaticShecudleAnalysis>();
+	PA.preserveSet<CFGAnalyses>();
+	return PA;
+}
+
+/* ================ Implementation of ModelSummaryPass ================= */
+PreservedAnalyses ModelSummaryPass::run(Module &M, ModuleAnalysisManager &AM)
+{
+	auto &MM = AM.getResult<ModelManagerPass>(M);
+
+	auto category_name = [](CGRAModel *model) -> StringRef {
+		for (auto &it : CGRAModel::CategoryMap) {
+			if (it.second == model->getKind()) {
+				return it.first();
+			}
+		}
+		return "unknown";
+	};
+
+	std::error_code EC;
+	raw_fd_ostream OS(OptDSESummaryFile, EC, sys::fs::OpenFlags::F_Text);
+	if (EC) {
+		ExitOnError Exit(ERR_MSG_PREFIX);
+		Exit(make_error<StringError>("Fail to open " + OptDSESummaryFile
+								+ ": " + EC.message(), EC));
+	}
+
+	OS << "model,category,kernels,verified,dfgs,nodes,edges\n";
+	for (unsigned i = 0; i < MM.getNumModels(); i++) {
+		auto &S = MM.getSummary(i);
+		auto line = formatv("{0},{1},{2},{3},{4},{5},{6}\n",
+						MM.getModelName(i), category_name(MM.getModel(i)),
+						S.kernels, S.verified, S.dfgs, S.nodes, S.edges);
+		OS << line;
+		if (OptVerbose) {
+			errs() << formatv("{0,-20} {1} kernels, "
+						"{2} verified, {3} DFGs ({4} nodes, {5} edges)\n",
+						MM.getModelName(i), S.kernels, S.verified,
+						S.dfgs, S.nodes, S.edges);
+		}
+	}
+
+	return PreservedAnalyses::all();
+}
+
 #undef DEBUG_TYPE
 
 static void registerModuleAnalyses(ModuleAnalysisManager &MAM)
@@ -386,42 +557,192 @@ static void registerPostOptimizationPasses(ModulePassManager &PM)
 	}
 }
 
-extern "C" ::llvm::PassPluginLibraryInfo LLVM_ATTRIBUTE_WEAK
-llvmGetPassPluginInfo() {
-	return {
-		LLVM_PLUGIN_API_VERSION, "CGRAOmp", LLVM_VERSION_STRING,
-		[](PassBuilder &PB) {
-			PB.registerPipelineParsingCallback(
-				[](StringRef Name, ModulePassManager &PM,
-					ArrayRef<PassBuilder::PipelineElement>){
-						if (Name == CGRAOMP_PASS_NAME) {
-							// make a pipeline
-							PM.addPass(RemoveScheduleRuntimePass());
-							registerPostOptimizationPasses(PM);
-
-							// Verify->DFGExraction->Runtime Insertion
-							PM.addPass(VerifyModulePass());
-							PM.addPass(DFGPassHandler());
-							return true;
-						}
-						// Expand analysis passes
-						#define MODULE_ANALYSIS(NAME, CREATE_PASS) \
-						if (Name == "require<" NAME ">") { \
-							PM.addPass( \
-								RequireAnalysisPass<std::remove_reference<decltype(CREATE_PASS)>::type, Module>()); \
-							return true; \
-						}
+/**
+ * @brief parameters of the pre-optimization pipeline
+ * 	cgraomp-preopt<O0|O1|O2|O3;unroll=N>
+ */
+struct PreOptParams {
+	unsigned OptLevel = 2;
+	/// max trip count of full unrolling, 0 disables unrolling
+	Optional<unsigned> Unroll;
+};
+
+static Optional<PreOptParams> parsePreOptParams(StringRef Name)
+{
+	PreOptParams Params;
+	if (!Name.consume_front(CGRAOMP_PREOPT_PASS_NAME)) {
+		return None;
+	}
+	if (Name.empty()) {
+		return Params;
+	}
+	if (!Name.consume_front("<") || !Name.consume_back(">")) {
+		return None;
+	}
+	while (!Name.empty()) {
+		StringRef ParamName;
+		std::tie(ParamName, Name) = Name.split(';');
+		unsigned N;
+		if (ParamName.size() == 2 && ParamName[0] == 'O' &&
+				ParamName[1] >= '0' && ParamName[1] <= '3') {
+			Params.OptLevel = ParamName[1] - '0';
+		} else if (ParamName.consume_front("unroll=") &&
+					!ParamName.getAsInteger(10, N)) {
+			Params.Unroll = N;
+		} else {
+			errs() << formatv(ERR_MSG_PREFIX "invalid parameter \"{0}\" for {1}\n",
+							ParamName, CGRAOMP_PREOPT_PASS_NAME);
+			return None;
+		}
+	}
+	return Params;
+}
+
+/**
+ * @brief loop canonicalization equivalent to -polly-canonicalize
+ */
+static void registerCanonicalizationPasses(ModulePassManager &PM)
+{
+	FunctionPassManager FPM;
+	FPM.addPass(PromotePass());
+	FPM.addPass(EarlyCSEPass());
+	FPM.addPass(InstCombinePass());
+	FPM.addPass(SimplifyCFGPass());
+	FPM.addPass(TailCallElimPass());
+	FPM.addPass(SimplifyCFGPass());
+	FPM.addPass(ReassociatePass());
+	FPM.addPass(createFunctionToLoopPassAdaptor(LoopRotatePass()));
+	FPM.addPass(InstCombinePass());
+	FPM.addPass(createFunctionToLoopPassAdaptor(IndVarSimplifyPass()));
+	PM.addPass(createModuleToFunctionPassAdaptor(std::move(FPM)));
+}
+
+/**
+ * @brief pre-optimization for kernel code
+ * 	It builds the same sequence as PRE_OPTS of cgraomp-cc had done with
+ * 	the legacy pass manager
+ */
+static void registerPreOptimizationPasses(ModulePassManager &PM,
+											const PreOptParams &Params)
+{
+	if (Params.OptLevel > 0) {
+		PM.addPass(InferFunctionAttrsPass());
+
+		FunctionPassManager FPM;
+		FPM.addPass(createFunctionToLoopPassAdaptor(IndVarSimplifyPass()));
+		if (!Params.Unroll || *Params.Unroll > 0) {
+			auto UnrollOpts = LoopUnrollOptions(Params.OptLevel).setPartial(true);
+			if (Params.Unroll) {
+				UnrollOpts.setFullUnrollMaxCount(*Params.Unroll);
+			}
+			FPM.addPass(LoopUnrollPass(UnrollOpts));
+		}
+		FPM.addPass(SimplifyCFGPass());
+		FPM.addPass(LoopSimplifyPass());
+		LoopPassManager LPM;
+		LPM.addPass(LoopIdiomRecognizePass());
+		LPM.addPass(LoopInstSimplifyPass());
+		LPM.addPass(LoopRotatePass());
+		FPM.addPass(createFunctionToLoopPassAdaptor(std::move(LPM)));
+		FPM.addPass(PromotePass());
+		FPM.addPass(InstCombinePass());
+		FPM.addPass(LoopLoadEliminationPass());
+		FPM.addPass(InstSimplifyPass());
+		FPM.addPass(EarlyCSEPass());
+		FPM.addPass(EarlyCSEPass(true));
+		FPM.addPass(DCEPass());
+		FPM.addPass(GVN());
+		PM.addPass(createModuleToFunctionPassAdaptor(std::move(FPM)));
+
+		PM.addPass(ConstantMergePass());
+
+		FunctionPassManager FPM2;
+		FPM2.addPass(SimplifyCFGPass());
+		FPM2.addPass(ReassociatePass());
+		FPM2.addPass(InstCombinePass());
+		FPM2.addPass(MergedLoadStoreMotionPass());
+		PM.addPass(createModuleToFunctionPassAdaptor(std::move(FPM2)));
+	}
+	registerCanonicalizationPasses(PM);
+}
 
-						#include "OmpPasses.def"
+void CGRAOmp::registerCGRAOmpPasses(PassBuilder &PB)
+{
+	PB.registerPipelineParsingCallback(
+		[](StringRef Name, ModulePassManager &PM,
+			ArrayRef<PassBuilder::PipelineElement>){
+				if (Name == CGRAOMP_PASS_NAME) {
+					// make a pipeline
+					PM.addPass(RemoveScheduleRuntimePass());
+					registerPostOptimizationPasses(PM);
+					// kernel hints are applied after the schedule runtime is removed
+					// so that the bounds of the work-shared loops become visible
+					PM.addPass(ApplyKernelHintPass());
+					PM.addPass(createModuleToFunctionPassAdaptor(
+								LoopUnrollPass(LoopUnrollOptions(2, true))));
+					PM.addPass(createModuleToFunctionPassAdaptor(InstCombinePass()));
+					PM.addPass(createModuleToFunctionPassAdaptor(SimplifyCFGPass()));
+
+					// Verify->DFGExraction->Runtime Insertion
+					// for each model on the same pre-optimized IR
+					unsigned num_models = std::max<unsigned>(
+										PathToCGRAConfig.size(), 1);
+					for (unsigned i = 0; i < num_models; i++) {
+						if (num_models > 1) {
+							PM.addPass(SelectModelPass(i));
+						}
+						PM.addPass(VerifyModulePass());
+						PM.addPass(DFGPassHandler());
+					}
+					if (num_models > 1) {
+						PM.addPass(ModelSummaryPass());
+					}
+					return true;
+				}
+				if (Name.startswith(CGRAOMP_PREOPT_PASS_NAME)) {
+					// pre-optimization sharing the analysis manager
+					// with the following cgraomp pipeline
+					auto Params = parsePreOptParams(Name);
+					if (!Params) {
 						return false;
+					}
+					registerPreOptimizationPasses(PM, *Params);
+					return true;
+				}
+				if (Name == CGRAOMP_TRANSFER_PASS_NAME) {
+					// for host code
+					PM.addPass(DataTransferReportPass());
+					return true;
+				}
+				if (Name == CGRAOMP_VERSIONING_PASS_NAME) {
+					// for host code
+					PM.addPass(KernelVersioningPass());
+					return true;
+				}
+				if (Name == CGRAOMP_HOST_HINT_PASS_NAME) {
+					// for host code
+					PM.addPass(HostFallbackHintPass());
+					return true;
+				}
+				// Expand analysis passes
+				#define MODULE_ANALYSIS(NAME, CREATE_PASS) \
+				if (Name == "require<" NAME ">") { \
+					PM.addPass( \
+						RequireAnalysisPass<std::remove_reference<decltype(CREATE_PASS)>::type, Module>()); \
+					return true; \
 				}
-			);
-
-			PB.registerAnalysisRegistrationCallback(registerModuleAnalyses);
-			PB.registerAnalysisRegistrationCallback(registerFunctionAnalyses);
-			PB.registerAnalysisRegistrationCallback(registerLoopAnalyses);
 
+				#include "OmpPasses.def"
+				return false;
 		}
-	};
+	);
+
+	PB.registerAnalysisRegistrationCallback(registerModuleAnalyses);
+	PB.registerAnalysisRegistrationCallback(registerFunctionAnalyses);
+	PB.registerAnalysisRegistrationCallback(registerLoopAnalyses);
 }
 
+extern "C" ::llvm::PassPluginLibraryInfo LLVM_ATTRIBUTE_WEAK
+llvmGetPassPluginInfo() {
+	return {LLVM_PLUGIN_API_VERSION, "CGRAOmp", LLVM_VERSION_STRING, registerCGRAOmpPasses};
+}
@@ -0,0 +1,504 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /src/Passes/CGRAOmpPass/DataTransferPlan.cpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 04:37:09
+*    Last Modified: 17-10-2026 04:37:09
+*/
+#include "common.hpp"
+#include "DataTransferPlan.hpp"
+#include "OptionPlugin.hpp"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+
+#include <functional>
+#include <tuple>
+
+using namespace llvm;
+using namespace CGRAOmp;
+
+#define DEBUG_TYPE "cgraomp"
+static const char *VerboseDebug = DEBUG_TYPE "-verbose";
+
+/**
+ * @brief get an identical value for a mapped variable
+ * @details If the pointer is loaded from a global variable,
+ * the global variable is used so that every load of it has the same key.
+ */
+static Value* getObjectKey(Value *V)
+{
+	auto obj = getUnderlyingObject(V);
+	if (auto load = dyn_cast<LoadInst>(obj)) {
+		auto src = getUnderlyingObject(load->getPointerOperand());
+		if (isa<GlobalVariable>(src)) {
+			return src;
+		}
+	}
+	return obj;
+}
+
+/// get an element of a constant global array
+static Optional<uint64_t> getConstElement(Value *Array, unsigned idx)
+{
+	if (auto GV = dyn_cast<GlobalVariable>(Array->stripPointerCasts())) {
+		if (GV->hasInitializer()) {
+			if (auto CDA = dyn_cast<ConstantDataArray>(GV->getInitializer())) {
+				if (idx < CDA->getNumElements()) {
+					return CDA->getElementAsInteger(idx);
+				}
+			}
+		}
+	}
+	return None;
+}
+
+/**
+ * @brief check if two GEP index lists point to the same element
+ * @details Missing trailing indices are regarded as zero because
+ * the address of the first sub-element is the same as that of the aggregate.
+ */
+static bool isSameElement(ArrayRef<int64_t> LHS, ArrayRef<int64_t> RHS)
+{
+	for (unsigned i = 0; i < std::max(LHS.size(), RHS.size()); i++) {
+		int64_t l = i < LHS.size() ? LHS[i] : 0;
+		int64_t r = i < RHS.size() ? RHS[i] : 0;
+		if (l != r) return false;
+	}
+	return true;
+}
+
+/**
+ * @brief find the value stored to an element of a local array
+ * @details The indices of chained GEPs are merged and compared with those of the element as a whole.
+ * If more than one store is found, the one preceding the call in the same basic block is preferred.
+ */
+static Value* findStoredElement(Value *Array, unsigned idx, CallBase *call)
+{
+	Value *stored = nullptr;
+	auto root = Array->stripPointerCasts();
+	// indices of the element from the root
+	SmallVector<int64_t, 2> target;
+	if (root->getType()->getPointerElementType()->isArrayTy()) {
+		target.push_back(0);
+	}
+	target.push_back(idx);
+
+	std::function<void(Value*, SmallVector<int64_t, 2>)> visit =
+			[&](Value *Ptr, SmallVector<int64_t, 2> indices) {
+		for (auto U : Ptr->users()) {
+			if (auto store = dyn_cast<StoreInst>(U)) {
+				if (store->getPointerOperand() != Ptr ||
+						!isSameElement(indices, target)) {
+					continue;
+				}
+				if (!stored || (store->getParent() == call->getParent() &&
+									store->comesBefore(call))) {
+					stored = store->getValueOperand();
+				}
+			} else if (auto gep = dyn_cast<GEPOperator>(U)) {
+				if (gep->getPointerOperand() != Ptr ||
+						!gep->hasAllConstantIndices()) {
+					continue;
+				}
+				// the first index of a chained GEP offsets the last one of the previous
+				auto next = indices;
+				bool first = true;
+				for (auto &I : gep->indices()) {
+					auto val = cast<ConstantInt>(I)->getSExtValue();
+					if (first && !next.empty()) {
+						next.back() += val;
+					} else {
+						next.push_back(val);
+					}
+					first = false;
+				}
+				visit(U, next);
+			} else if (auto op = dyn_cast<Operator>(U)) {
+				if (op->getOpcode() == Instruction::BitCast) {
+					visit(U, indices);
+				}
+			}
+		}
+	};
+	visit(root, {});
+	return stored;
+}
+
+/* ================= Implementation of TransferEntry ================= */
+json::Value TransferEntry::toJson() const
+{
+	json::Object json_obj({
+		{"symbol", symbol},
+		{"map_type", (int64_t)map_type},
+		{"to_device", to_device},
+		{"from_device", from_device},
+		{"resident", resident},
+		{"redundant", redundant},
+	});
+	if (size >= 0) {
+		json_obj["size"] = size;
+	} else {
+		// determined at runtime
+		json_obj["size"] = nullptr;
+	}
+	if (!reused_from.empty()) {
+		json_obj["reused_from"] = reused_from;
+	}
+	return json::Value(std::move(json_obj));
+}
+
+/* ================= Implementation of TransferEvent ================= */
+int64_t TransferEvent::getTransferBytes(bool to_device) const
+{
+	int64_t bytes = 0;
+	for (auto &entry : entries) {
+		bool moved = to_device ? entry.to_device : entry.from_device;
+		if (moved && entry.size > 0) {
+			bytes += entry.size;
+		}
+	}
+	return bytes;
+}
+
+json::Value TransferEvent::toJson() const
+{
+	StringRef kind_str;
+	switch (kind) {
+		case Kind::Enter: kind_str = "enter"; break;
+		case Kind::Exit: kind_str = "exit"; break;
+		case Kind::Update: kind_str = "update"; break;
+		case Kind::Kernel: kind_str = "kernel"; break;
+	}
+	json::Array transfers;
+	for (auto &entry : entries) {
+		transfers.push_back(entry.toJson());
+	}
+	json::Object json_obj({
+		{"kind", kind_str},
+		{"function", call->getFunction()->getName()},
+		{"bytes_to_device", getTransferBytes(true)},
+		{"bytes_from_device", getTransferBytes(false)},
+		{"transfers", std::move(transfers)},
+	});
+	if (kind == Kind::Kernel) {
+		json_obj["kernel"] = kernel_name;
+	}
+	return json::Value(std::move(json_obj));
+}
+
+/* ================= Implementation of DataTransferPlan ================= */
+Error DataTransferPlan::saveAsJson(StringRef filepath)
+{
+	// open file
+	error_code EC;
+	raw_fd_ostream File(filepath, EC, sys::fs::OpenFlags::F_Text);
+	json::OStream JS(File, 4);
+
+	if (!EC) {
+		JS.object([&]() {
+			JS.attributeArray("events", [&]() {
+				for (auto &E : event_list) {
+					JS.value(E.toJson());
+				}
+			});
+		});
+	} else {
+		return errorCodeToError(EC);
+	}
+	return ErrorSuccess();
+}
+
+/* ============= Implementation of DataTransferAnalysisPass ============= */
+AnalysisKey DataTransferAnalysisPass::Key;
+
+DataTransferAnalysisPass::Result DataTransferAnalysisPass::run(Module &M,
+										ModuleAnalysisManager &AM)
+{
+	using Kind = TransferEvent::Kind;
+	Result result;
+
+	LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << "Analyzing data transfer for target directives\n");
+	for (auto &F : M) {
+		if (F.isDeclaration()) continue;
+		// reference count of each variable on the device
+		DenseMap<Value*, int> present;
+		// the last kernel using each resident variable
+		DenseMap<Value*, std::string> last_user;
+		// the last kernel copying back each variable and its enclosing target data region
+		DenseMap<Value*, std::tuple<CallBase*, std::string, CallBase*>> copied_back;
+		// the beginning of the enclosing target data regions
+		SmallVector<CallBase*> regions;
+
+		ReversePostOrderTraversal<Function*> RPOT(&F);
+		for (auto BB : RPOT) {
+			for (auto &I : *BB) {
+				auto call = dyn_cast<CallBase>(&I);
+				if (!call) continue;
+				auto event = parseRuntimeCall(call);
+				if (!event) continue;
+				auto kind = event->getKind();
+				// the device copy of a kernel is freed when the innermost region ends
+				CallBase *region = regions.empty() ? nullptr : regions.back();
+				for (auto &entry : event->getEntries()) {
+					bool to = entry.map_type & OMP_TGT_MAPTYPE_TO;
+					bool from = entry.map_type & OMP_TGT_MAPTYPE_FROM;
+					bool always = entry.map_type & OMP_TGT_MAPTYPE_ALWAYS;
+					auto obj = entry.obj;
+					int count = (obj && present.count(obj)) ? present[obj] : 0;
+					switch (kind) {
+						case Kind::Enter:
+							entry.to_device = to && (count == 0 || always);
+							entry.resident = count > 0;
+							if (obj) present[obj] = count + 1;
+							break;
+						case Kind::Exit:
+							if (entry.map_type & OMP_TGT_MAPTYPE_DELETE) {
+								count = 0;
+							} else if (count > 0) {
+								count--;
+							}
+							entry.from_device = from && (count == 0 || always);
+							if (obj) {
+								present[obj] = count;
+								if (count == 0) last_user.erase(obj);
+							}
+							break;
+						case Kind::Update:
+							entry.to_device = to;
+							entry.from_device = from;
+							entry.resident = count > 0;
+							break;
+						case Kind::Kernel:
+							if (count > 0) {
+								// the runtime does not copy present data
+								entry.resident = true;
+								entry.to_device = to && always;
+								entry.from_device = from && always;
+								if (last_user.count(obj)) {
+									entry.reused_from = last_user[obj];
+								}
+								last_user[obj] = event->getKernelName().str();
+								break;
+							}
+							entry.to_device = to;
+							entry.from_device = from;
+							if (!obj) break;
+							if (to && region && copied_back.count(obj)) {
+								CallBase *prev;
+								std::string prev_name;
+								CallBase *prev_region;
+								std::tie(prev, prev_name, prev_region) = copied_back[obj];
+								if (prev_region == region &&
+										prev->getParent() == call->getParent() &&
+										!mayHostAccess(prev, call, obj)) {
+									entry.redundant = true;
+									entry.reused_from = prev_name;
+								}
+							}
+							if (from) {
+								copied_back[obj] = std::make_tuple(call,
+												event->getKernelName().str(), region);
+								continue;
+							}
+							break;
+					}
+					// other directives and kernels without copy-back
+					if (obj) copied_back.erase(obj);
+				}
+				if (kind == Kind::Enter) {
+					regions.push_back(call);
+				} else if (kind == Kind::Exit && !regions.empty()) {
+					regions.pop_back();
+				}
+
+				DEBUG_WITH_TYPE(VerboseDebug,
+					dbgs() << DBG_DEBUG_PREFIX << formatv(
+						"{0} in {1}: {2} bytes to device, {3} bytes from device\n",
+						call->getCalledFunction()->getName(), F.getName(),
+						event->getTransferBytes(true),
+						event->getTransferBytes(false));
+					for (auto &entry : event->getEntries()) {
+						if (entry.redundant) {
+							dbgs() << DBG_DEBUG_PREFIX << "\tredundant copy-in of "
+								<< entry.symbol << "\n";
+						}
+					});
+				result.add_event(std::move(*event));
+			}
+		}
+	}
+
+	return result;
+}
+
+/**
+ * @details The arguments of __tgt_target* are located relative to the map types array
+ * so that both the variants with and without mappers are handled:
+ * (..., arg_num, args_base, args, arg_sizes, arg_types, ...)
+ */
+Optional<TransferEvent> DataTransferAnalysisPass::parseRuntimeCall(CallBase *call)
+{
+	using Kind = TransferEvent::Kind;
+	auto callee = call->getCalledFunction();
+	if (!callee) return None;
+	auto name = callee->getName();
+	if (!name.startswith("__tgt_target")) return None;
+
+	Kind kind;
+	if (name.startswith("__tgt_target_data_begin")) {
+		kind = Kind::Enter;
+	} else if (name.startswith("__tgt_target_data_end")) {
+		kind = Kind::Exit;
+	} else if (name.startswith("__tgt_target_data_update")) {
+		kind = Kind::Update;
+	} else {
+		kind = Kind::Kernel;
+	}
+
+	// find the map types
+	int maptype_idx = -1;
+	for (unsigned i = 0; i < call->arg_size(); i++) {
+		auto arg = call->getArgOperand(i)->stripPointerCasts();
+		if (auto GV = dyn_cast<GlobalVariable>(arg)) {
+			if (GV->getName().startswith(OFFLOAD_MAPTYPES_PREFIX)) {
+				maptype_idx = i;
+				break;
+			}
+		}
+	}
+	if (maptype_idx < 4) {
+		DEBUG_WITH_TYPE(VerboseDebug, dbgs() << DBG_DEBUG_PREFIX
+			<< "map types are not found for " << name << "\n");
+		return None;
+	}
+	auto arg_num = dyn_cast<ConstantInt>(call->getArgOperand(maptype_idx - 4));
+	if (!arg_num) return None;
+	auto maptypes = call->getArgOperand(maptype_idx);
+	auto sizes = call->getArgOperand(maptype_idx - 1);
+	auto base_ptrs = call->getArgOperand(maptype_idx - 3);
+
+	TransferEvent event(kind, call);
+	if (kind == Kind::Kernel) {
+		// find the region ID of the offloading function
+		for (auto &arg : call->args()) {
+			auto GV = dyn_cast<GlobalVariable>(arg->stripPointerCasts());
+			if (GV && GV->getName().endswith(REGION_ID_SUFFIX)) {
+				auto region = GV->getName().drop_back(strlen(REGION_ID_SUFFIX));
+				event.setKernelName(region.ltrim('.'));
+				break;
+			}
+		}
+	}
+
+	for (unsigned i = 0; i < arg_num->getZExtValue(); i++) {
+		TransferEntry entry;
+		entry.map_type = getConstElement(maptypes, i).getValueOr(0);
+		// scalars passed by value are not transferred
+		if (entry.map_type &
+				(OMP_TGT_MAPTYPE_LITERAL | OMP_TGT_MAPTYPE_PRIVATE)) {
+			continue;
+		}
+		// size
+		if (auto size = getConstElement(sizes, i)) {
+			entry.size = *size;
+		} else if (auto cint = dyn_cast_or_null<ConstantInt>(
+						findStoredElement(sizes, i, call))) {
+			entry.size = cint->getSExtValue();
+		} else {
+			entry.size = -1;
+		}
+		// variable
+		entry.obj = nullptr;
+		entry.symbol = "unknown";
+		if (auto base = findStoredElement(base_ptrs, i, call)) {
+			entry.obj = getObjectKey(base->stripPointerCasts());
+			if (entry.obj->hasName()) {
+				entry.symbol = entry.obj->getName().str();
+			}
+		}
+		event.addEntry(std::move(entry));
+	}
+
+	return event;
+}
+
+bool DataTransferAnalysisPass::mayHostAccess(Instruction *From, Instruction *To,
+												Value *obj)
+{
+	for (auto I = From->getNextNode(); I && I != To; I = I->getNextNode()) {
+		if (!I->mayReadOrWriteMemory()) continue;
+		if (auto call = dyn_cast<CallBase>(I)) {
+			if (isa<DbgInfoIntrinsic>(call) || call->isLifetimeStartOrEnd()) {
+				continue;
+			}
+			if (call->doesNotAccessMemory() ||
+					call->onlyAccessesInaccessibleMemory()) {
+				continue;
+			}
+			auto callee = call->getCalledFunction();
+			if (callee && callee->getName().startswith("__tgt_")) {
+				continue;
+			}
+			return true;
+		}
+		auto ptr = getLoadStorePointerOperand(I);
+		if (!ptr) return true;
+		auto key = getObjectKey(ptr);
+		if (key == obj || !isIdentifiedObject(key)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* ============= Implementation of DataTransferReportPass ============= */
+PreservedAnalyses DataTransferReportPass::run(Module &M,
+												ModuleAnalysisManager &AM)
+{
+	auto &plan = AM.getResult<DataTransferAnalysisPass>(M);
+
+	LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << "Saving data transfer plan: "
+				<< OptTransferPlanFile << "\n");
+	Error E = plan.saveAsJson(OptTransferPlanFile);
+	if (E) {
+		ExitOnError Exit(ERR_MSG_PREFIX);
+		Exit(std::move(E));
+	}
+
+	return PreservedAnalyses::all();
+}
+
+#undef DEBUG_TYPE
@@ -0,0 +1,225 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /src/Passes/CGRAOmpPass/KernelHint.cpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 05:13:04
+*    Last Modified: 17-10-2026 05:13:04
+*/
+#include "common.hpp"
+#include "KernelHint.hpp"
+#include "CGRAOmpPass.hpp"
+
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Transforms/Utils/LoopUtils.h"
+
+using namespace llvm;
+using namespace CGRAOmp;
+
+#define DEBUG_TYPE "cgraomp"
+
+/* ================ Implementation of KernelHintAnalysisPass ================= */
+AnalysisKey KernelHintAnalysisPass::Key;
+
+KernelHintAnalysisPass::Result
+KernelHintAnalysisPass::run(Module &M, ModuleAnalysisManager &AM)
+{
+	Result result;
+	auto &kernel_info = AM.getResult<OmpKernelAnalysisPass>(M);
+
+	for (auto F : kernel_info.kernels()) {
+		KernelHint hint;
+		bool found = false;
+		// hints for the whole target region
+		auto offload = kernel_info.getOffloadFunction(F);
+		if (offload && offload != F) {
+			found |= parseHints(*offload, hint);
+		}
+		// hints in the kernel itself
+		found |= parseHints(*F, hint);
+		if (found) {
+			LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << "Kernel hints are given to "
+						<< F->getName() << "\n");
+			result.setHint(F, hint);
+		}
+	}
+
+	return result;
+}
+
+Optional<StringRef> KernelHintAnalysisPass::getHintString(Instruction &I)
+{
+	if (auto II = dyn_cast<IntrinsicInst>(&I)) {
+		if (II->getIntrinsicID() == Intrinsic::annotation) {
+			StringRef str;
+			if (getConstantStringInfo(II->getArgOperand(1), str) &&
+					str.consume_front(CGRAOMP_HINT_PREFIX)) {
+				return str;
+			}
+		}
+	}
+	return None;
+}
+
+/**
+ * @details A hint is a string in the form of "key=value".
+ * Invalid hints are ignored with a warning.
+*/
+bool KernelHintAnalysisPass::parseHints(Function &F, KernelHint &hint)
+{
+	bool found = false;
+	for (auto &I : instructions(F)) {
+		auto hint_str = getHintString(I);
+		if (!hint_str) continue;
+		found = true;
+
+		StringRef key, val;
+		std::tie(key, val) = hint_str->split('=');
+		key = key.trim();
+		val = val.trim();
+
+		auto warn = [&](StringRef reason) {
+			errs() << formatv(WARN_MSG_PREFIX "ignoring hint \"{0}\" in {1}: {2}\n",
+								*hint_str, F.getName(), reason);
+		};
+		auto set_positive = [&](Optional<int> &dst) {
+			int n;
+			if (val.getAsInteger(10, n) || n <= 0) {
+				warn("a positive integer is expected");
+			} else {
+				dst = n;
+			}
+		};
+
+		if (key == HINT_II_KEY) {
+			set_positive(hint.ii);
+		} else if (key == HINT_UNROLL_KEY) {
+			set_positive(hint.unroll);
+		} else if (key == HINT_FANOUT_KEY) {
+			set_positive(hint.max_fanout);
+		} else if (key == HINT_NO_OFFLOAD_KEY) {
+			hint.no_offload = true;
+		} else if (key == HINT_MODEL_KEY) {
+			if (val.empty()) {
+				warn("a model name is expected");
+			} else {
+				hint.model = val.str();
+			}
+		} else if (key == HINT_PIPELINE_KEY) {
+			// an empty pipeline disables all the DFG passes
+			SmallVector<StringRef> passes;
+			val.split(passes, ',', -1, false);
+			SmallVector<std::string> pipeline;
+			for (auto pass : passes) {
+				pipeline.push_back(pass.trim().str());
+			}
+			hint.dfg_pipeline = pipeline;
+		} else {
+			warn("unknown hint");
+		}
+	}
+	return found;
+}
+
+/* ================ Implementation of ApplyKernelHintPass ================= */
+PreservedAnalyses ApplyKernelHintPass::run(Module &M, ModuleAnalysisManager &AM)
+{
+	auto &hints = AM.getResult<KernelHintAnalysisPass>(M);
+	auto &kernel_info = AM.getResult<OmpKernelAnalysisPass>(M);
+	auto &FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+	bool changed = false;
+
+	// attach the unroll factor to the innermost loops of the kernel
+	for (auto F : kernel_info.kernels()) {
+		auto hint = hints.getHint(F);
+		if (!hint || !hint->unroll) continue;
+		auto &LI = FAM.getResult<LoopAnalysis>(*F);
+		auto &SE = FAM.getResult<ScalarEvolutionAnalysis>(*F);
+		SmallVector<Loop*> innermost;
+		for (auto L : LI.getLoopsInPreorder()) {
+			if (L->isInnermost()) {
+				innermost.push_back(L);
+			}
+		}
+		// a remainder loop would be detected as another kernel
+		auto has_remainder = any_of(innermost, [&](Loop *L) {
+			return SE.getSmallConstantTripMultiple(L) % *hint->unroll != 0;
+		});
+		if (has_remainder) {
+			errs() << formatv(WARN_MSG_PREFIX "ignoring hint \"{0}={1}\" in {2}: "
+						"the trip count is not known to be a multiple of {1}\n",
+						HINT_UNROLL_KEY, *hint->unroll, F->getName());
+			KernelHint new_hint = *hint;
+			new_hint.unroll = None;
+			hints.setHint(F, new_hint);
+			continue;
+		}
+		auto &Ctx = F->getContext();
+		MDNode *count = MDNode::get(Ctx, {
+			MDString::get(Ctx, "llvm.loop.unroll.count"),
+			ConstantAsMetadata::get(ConstantInt::get(Type::getInt32Ty(Ctx),
+														*hint->unroll))
+		});
+		for (auto L : innermost) {
+			// overwrite the unroll settings by the pre-optimization
+			L->setLoopID(makePostTransformationMetadata(Ctx, L->getLoopID(),
+							{"llvm.loop.unroll."}, {count}));
+			changed = true;
+		}
+	}
+
+	// remove the hints not to be regarded as a part of the kernels
+	SmallVector<Instruction*> hint_insts;
+	for (auto &F : M) {
+		for (auto &I : instructions(F)) {
+			if (KernelHintAnalysisPass::getHintString(I)) {
+				hint_insts.push_back(&I);
+			}
+		}
+	}
+	for (auto I : hint_insts) {
+		// llvm.annotation returns the first operand as it is
+		I->replaceAllUsesWith(I->getOperand(0));
+		I->eraseFromParent();
+	}
+	changed |= !hint_insts.empty();
+
+	if (!changed) {
+		return PreservedAnalyses::all();
+	}
+	PreservedAnalyses PA;
+	PA.preserve<KernelHintAnalysisPass>();
+	PA.preserve<OmpKernelAnalysisPass>();
+	PA.preserve<ModelManagerPass>();
+	PA.preserveSet<CFGAnalyses>();
+	return PA;
+}
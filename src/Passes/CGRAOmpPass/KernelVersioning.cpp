@@ -0,0 +1,571 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /src/Passes/CGRAOmpPass/KernelVersioning.cpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 04:47:21
+*    Last Modified: 17-10-2026 04:47:21
+*/
+#include "common.hpp"
+#include "KernelVersioning.hpp"
+#include "CGRAOmpPass.hpp"
+#include "CGRAModel.hpp"
+#include "DataTransferPlan.hpp"
+#include "KernelHint.hpp"
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+
+#include <memory>
+
+using namespace llvm;
+using namespace CGRAOmp;
+
+#define DEBUG_TYPE "cgraomp"
+
+/// the maximum depth of the expression to be re-computed
+#define MAX_MATERIALIZE_DEPTH	32
+
+namespace {
+	/**
+	 * @class TripCountMaterializer
+	 * @brief re-compute a value of the outlined parallel region at the kernel launch site
+	 */
+	class TripCountMaterializer {
+		public:
+			/// where a value is defined
+			enum class Level {
+				/// outlined parallel region (micro task)
+				MicroTask,
+				/// function calling __kmpc_fork_call
+				Fork,
+				/// function launching the kernel
+				Host,
+			};
+
+			/**
+			 * @param launch call of __tgt_target*
+			 * @param fork call of __kmpc_fork_call
+			 * @param fallback call of the fallback function including @em fork (nullptr if it is inlined)
+			 * @param DT dominator tree of the host function
+			 * @param is_signed whether the loop induction variable is signed
+			 */
+			TripCountMaterializer(CallBase *launch, CallBase *fork,
+									CallBase *fallback, DominatorTree &DT,
+									bool is_signed) :
+				launch(launch), fork(fork), fallback(fallback), DT(DT),
+				B(launch), is_signed(is_signed) {};
+
+			/**
+			 * @brief re-compute a value before the launch
+			 * @return Value* the value available at the launch, or nullptr if it fails
+			 */
+			Value* materialize(Value *V, Level lvl, int depth = 0);
+
+		private:
+			CallBase *launch, *fork, *fallback;
+			DominatorTree &DT;
+			IRBuilder<> B;
+			bool is_signed;
+			/// dominator tree of the fallback function (computed on demand)
+			std::unique_ptr<DominatorTree> ForkDT;
+
+			/**
+			 * @brief get the only store to an alloca which is executed before the value is used
+			 * @details The store must dominate the launch for the host function, or the fork for the fallback function.
+			 * @return StoreInst* the store, or nullptr if the value may be changed
+			 */
+			StoreInst* getDominatingStore(AllocaInst *A, Level lvl);
+
+			/// re-compute a value loaded from a pointer
+			Value* materializeLoad(Value *Ptr, Type *Ty, Level lvl, int depth);
+
+			/// clone a simple instruction whose operands are re-computed
+			Value* cloneWith(Instruction *I, Level lvl, int depth);
+
+			/// check if a value of the host function is available at the launch
+			bool isAvailable(Value *V) {
+				if (auto I = dyn_cast<Instruction>(V)) {
+					return I->getFunction() == launch->getFunction() &&
+							DT.dominates(I, launch);
+				}
+				return isa<Argument>(V) &&
+					cast<Argument>(V)->getParent() == launch->getFunction();
+			}
+
+			/// true if the fork is in the host function
+			bool isForkInHost() const {
+				return fallback == nullptr;
+			}
+	};
+}
+
+/**
+ * @brief get the only store to an alloca
+ * @return StoreInst* the store, or nullptr if the alloca is used by anything else than loads and bitcasts
+ */
+static StoreInst* getSingleStore(AllocaInst *A)
+{
+	StoreInst *found = nullptr;
+	SmallVector<Value*> worklist = {A};
+	while (!worklist.empty()) {
+		auto V = worklist.pop_back_val();
+		for (auto U : V->users()) {
+			if (auto store = dyn_cast<StoreInst>(U)) {
+				if (store->getValueOperand() == V || found) {
+					// escaped or stored twice
+					return nullptr;
+				}
+				found = store;
+			} else if (isa<BitCastInst>(U)) {
+				worklist.push_back(U);
+			} else if (!isa<LoadInst>(U)) {
+				// it may be modified via the other users
+				return nullptr;
+			}
+		}
+	}
+	return found;
+}
+
+StoreInst* TripCountMaterializer::getDominatingStore(AllocaInst *A, Level lvl)
+{
+	auto store = getSingleStore(A);
+	if (!store) return nullptr;
+	if (lvl == Level::Host) {
+		return (store->getFunction() == launch->getFunction() &&
+				DT.dominates(store, launch)) ? store : nullptr;
+	}
+	if (lvl == Level::Fork) {
+		if (store->getFunction() != fork->getFunction()) return nullptr;
+		if (!ForkDT) {
+			ForkDT = std::make_unique<DominatorTree>(*fork->getFunction());
+		}
+		return ForkDT->dominates(store, fork) ? store : nullptr;
+	}
+	return nullptr;
+}
+
+Value* TripCountMaterializer::materialize(Value *V, Level lvl, int depth)
+{
+	if (depth > MAX_MATERIALIZE_DEPTH) return nullptr;
+	if (isa<Constant>(V)) return V;
+	if (lvl == Level::Fork && isForkInHost()) {
+		lvl = Level::Host;
+	}
+
+	switch (lvl) {
+		case Level::MicroTask:
+			// captured variables: (gtid, btid, var1, var2, ...)
+			if (auto arg = dyn_cast<Argument>(V)) {
+				if (arg->getArgNo() < 2) return nullptr;
+				return materialize(fork->getArgOperand(arg->getArgNo() + 1),
+									Level::Fork, depth + 1);
+			}
+			if (auto load = dyn_cast<LoadInst>(V)) {
+				auto ptr = load->getPointerOperand()->stripPointerCasts();
+				if (auto arg = dyn_cast<Argument>(ptr)) {
+					if (arg->getArgNo() < 2) return nullptr;
+					return materializeLoad(
+						fork->getArgOperand(arg->getArgNo() + 1),
+						load->getType(), Level::Fork, depth + 1);
+				}
+				return nullptr;
+			}
+			break;
+		case Level::Fork:
+			if (auto arg = dyn_cast<Argument>(V)) {
+				return materialize(fallback->getArgOperand(arg->getArgNo()),
+									Level::Host, depth + 1);
+			}
+			if (auto load = dyn_cast<LoadInst>(V)) {
+				return materializeLoad(load->getPointerOperand(),
+									load->getType(), lvl, depth + 1);
+			}
+			break;
+		case Level::Host:
+			if (isAvailable(V)) return V;
+			if (auto load = dyn_cast<LoadInst>(V)) {
+				return materializeLoad(load->getPointerOperand(),
+									load->getType(), lvl, depth + 1);
+			}
+			break;
+	}
+
+	if (auto I = dyn_cast<Instruction>(V)) {
+		return cloneWith(I, lvl, depth + 1);
+	}
+	return nullptr;
+}
+
+Value* TripCountMaterializer::materializeLoad(Value *Ptr, Type *Ty,
+												Level lvl, int depth)
+{
+	if (depth > MAX_MATERIALIZE_DEPTH) return nullptr;
+	if (lvl == Level::Fork && isForkInHost()) {
+		lvl = Level::Host;
+	}
+	auto obj = Ptr->stripPointerCasts();
+
+	// captured by the alloca whose value is stored only once
+	if (auto alloca = dyn_cast<AllocaInst>(obj)) {
+		if (auto store = getDominatingStore(alloca, lvl)) {
+			auto V = materialize(store->getValueOperand(), lvl, depth + 1);
+			if (!V) return nullptr;
+			if (V->getType() == Ty) return V;
+			if (V->getType()->isIntegerTy() && Ty->isIntegerTy()) {
+				// follow the signedness of the induction variable
+				return is_signed ? B.CreateSExtOrTrunc(V, Ty) :
+									B.CreateZExtOrTrunc(V, Ty);
+			}
+			return nullptr;
+		}
+	}
+
+	if (lvl == Level::Fork) {
+		if (auto arg = dyn_cast<Argument>(obj)) {
+			return materializeLoad(fallback->getArgOperand(arg->getArgNo()),
+									Ty, Level::Host, depth + 1);
+		}
+	} else if (lvl == Level::Host) {
+		// load the current value at the launch
+		if (isa<GlobalVariable>(obj) || isAvailable(Ptr)) {
+			auto cast_ptr = B.CreatePointerCast(Ptr, Ty->getPointerTo(
+								Ptr->getType()->getPointerAddressSpace()));
+			return B.CreateLoad(Ty, cast_ptr);
+		}
+	}
+	return nullptr;
+}
+
+Value* TripCountMaterializer::cloneWith(Instruction *I, Level lvl, int depth)
+{
+	if (!isa<BinaryOperator>(I) && !isa<CastInst>(I) &&
+			!isa<CmpInst>(I) && !isa<SelectInst>(I)) {
+		return nullptr;
+	}
+	SmallVector<Value*> operands;
+	for (auto &op : I->operands()) {
+		auto V = materialize(op.get(), lvl, depth);
+		if (!V) return nullptr;
+		operands.push_back(V);
+	}
+	auto clone = I->clone();
+	for (unsigned i = 0; i < operands.size(); i++) {
+		clone->setOperand(i, operands[i]);
+	}
+	return B.Insert(clone);
+}
+
+/* ================= Implementation of KernelVersioningPass ================= */
+PreservedAnalyses KernelVersioningPass::run(Module &M, ModuleAnalysisManager &AM)
+{
+	auto &MM = AM.getResult<ModelManagerPass>(M);
+	auto model = MM.getModel();
+	int threshold = model->getMinOffloadTripCount();
+	if (threshold <= 0) {
+		LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << "Kernel versioning is disabled by the model\n");
+		return PreservedAnalyses::all();
+	}
+
+	auto &plan = AM.getResult<DataTransferAnalysisPass>(M);
+	auto &FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+
+	SmallVector<CallBase*> launches;
+	for (auto &event : plan.events()) {
+		if (event.getKind() != TransferEvent::Kind::Kernel) continue;
+		auto resident = any_of(event.getEntries(), [](TransferEntry &E) {
+			return E.resident;
+		});
+		if (resident) {
+			LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << event.getKernelName()
+						<< " uses resident data and is not versioned\n");
+			continue;
+		}
+		launches.push_back(event.getCall());
+	}
+
+	bool changed = false;
+	for (auto launch : launches) {
+		changed |= versionKernel(launch, threshold, FAM);
+	}
+
+	return changed ? PreservedAnalyses::none() : PreservedAnalyses::all();
+}
+
+/**
+ * @brief find the basic block of the host fallback for a kernel launch
+ * @return BasicBlock* the fallback, or nullptr if it is not found
+ */
+static BasicBlock* findHostFallback(CallBase *launch)
+{
+	// find the fallback: br (icmp ne %ret, 0), %failed, %cont
+	BasicBlock *failed = nullptr;
+	for (auto U : launch->users()) {
+		auto cmp = dyn_cast<ICmpInst>(U);
+		if (!cmp || !isa<ConstantInt>(cmp->getOperand(1)) ||
+				!cast<ConstantInt>(cmp->getOperand(1))->isZero()) continue;
+		for (auto CU : cmp->users()) {
+			if (auto br = dyn_cast<BranchInst>(CU)) {
+				if (cmp->getPredicate() == ICmpInst::ICMP_NE) {
+					failed = br->getSuccessor(0);
+				} else if (cmp->getPredicate() == ICmpInst::ICMP_EQ) {
+					failed = br->getSuccessor(1);
+				}
+			}
+		}
+	}
+	if (!failed || isa<PHINode>(failed->front()) ||
+			failed == launch->getParent()) {
+		LLVM_DEBUG(dbgs() << WARN_DEBUG_PREFIX << "host fallback is not found for "
+					<< *launch << "\n");
+		return nullptr;
+	}
+	return failed;
+}
+
+bool KernelVersioningPass::versionKernel(CallBase *launch, int threshold,
+											FunctionAnalysisManager &FAM)
+{
+	using Level = TripCountMaterializer::Level;
+	auto &F = *(launch->getFunction());
+
+	// the result of the launch is merged with the skipped one
+	if (!isa<CallInst>(launch) || !launch->getType()->isIntegerTy()) {
+		return false;
+	}
+	auto failed = findHostFallback(launch);
+	if (!failed) {
+		return false;
+	}
+
+	// find __kmpc_fork_call in the fallback
+	// the trip count is derived only if the fallback has a single parallel region
+	CallBase *fork = nullptr, *fallback = nullptr;
+	int num_forks = 0;
+	auto is_fork = [](Instruction &I) {
+		auto call = dyn_cast<CallBase>(&I);
+		return call && call->getCalledFunction() &&
+			call->getCalledFunction()->getName() == "__kmpc_fork_call";
+	};
+	for (auto &I : *failed) {
+		auto call = dyn_cast<CallBase>(&I);
+		if (!call) continue;
+		if (is_fork(I)) {
+			fork = call;
+			fallback = nullptr;
+			num_forks++;
+			continue;
+		}
+		auto callee = call->getCalledFunction();
+		if (callee && !callee->isDeclaration()) {
+			for (auto &CI : instructions(*callee)) {
+				if (is_fork(CI)) {
+					fork = cast<CallBase>(&CI);
+					fallback = call;
+					num_forks++;
+				}
+			}
+		}
+	}
+	if (num_forks > 1) {
+		LLVM_DEBUG(dbgs() << WARN_DEBUG_PREFIX << "the fallback of " << F.getName()
+					<< " has " << num_forks << " parallel regions and is not versioned\n");
+		return false;
+	}
+	auto micro_task = (fork) ? dyn_cast<Function>(
+				fork->getArgOperand(2)->stripPointerCasts()) : nullptr;
+	if (!micro_task) {
+		LLVM_DEBUG(dbgs() << WARN_DEBUG_PREFIX << "parallel region is not found in the fallback of "
+					<< F.getName() << "\n");
+		return false;
+	}
+
+	// bounds of the normalized loop
+	auto &SI = FAM.getResult<OmpStaticShecudleAnalysis>(*micro_task);
+	if (!SI) return false;
+	auto &MDT = FAM.getResult<DominatorTreeAnalysis>(*micro_task);
+	auto get_init_value = [&](Value *ptr) -> Value* {
+		auto alloca = dyn_cast<AllocaInst>(ptr->stripPointerCasts());
+		if (!alloca) return nullptr;
+		StoreInst *init = nullptr;
+		for (auto U : alloca->users()) {
+			auto store = dyn_cast<StoreInst>(U);
+			if (store && MDT.dominates(store, SI.get_caller())) {
+				// multiple initialization
+				if (init) return nullptr;
+				init = store;
+			}
+		}
+		return (init) ? init->getValueOperand() : nullptr;
+	};
+	auto lb = get_init_value(SI.get_lower_bound());
+	auto ub = get_init_value(SI.get_upper_bound());
+	if (!lb || !ub) return false;
+
+	// __kmpc_for_static_init_{4,8}u for unsigned induction variables
+	auto init_name = SI.get_caller()->getCalledFunction()->getName();
+	bool is_signed = !init_name.endswith("u");
+
+	auto &DT = FAM.getResult<DominatorTreeAnalysis>(F);
+	auto prev = launch->getPrevNode();
+	TripCountMaterializer TM(launch, fork, fallback, DT, is_signed);
+	auto lb_val = TM.materialize(lb, Level::MicroTask);
+	auto ub_val = TM.materialize(ub, Level::MicroTask);
+	if (!lb_val || !ub_val || lb_val->getType() != ub_val->getType()) {
+		LLVM_DEBUG(dbgs() << WARN_DEBUG_PREFIX << "trip count of "
+					<< micro_task->getName() << " is not available at the launch\n");
+		// remove partially re-computed values
+		while (launch->getPrevNode() != prev) {
+			launch->getPrevNode()->eraseFromParent();
+		}
+		return false;
+	}
+
+	// trip_count = ub - lb + 1 < threshold
+	IRBuilder<> B(launch);
+	auto Ty = ub_val->getType();
+	auto trip_count = B.CreateAdd(B.CreateSub(ub_val, lb_val),
+									ConstantInt::get(Ty, 1), "trip_count");
+	auto is_small = is_signed ?
+		B.CreateICmpSLT(trip_count, ConstantInt::get(Ty, threshold), "is_small_kernel") :
+		B.CreateICmpULT(trip_count, ConstantInt::get(Ty, threshold), "is_small_kernel");
+
+	// the launch is skipped for small kernels and its result becomes non-zero
+	// so that the existing check takes the fallback
+	// the values around the launch keep dominating their uses
+	Instruction *skip_term, *launch_term;
+	SplitBlockAndInsertIfThenElse(is_small, launch, &skip_term, &launch_term);
+	auto skip_bb = skip_term->getParent();
+	auto launch_bb = launch_term->getParent();
+	skip_bb->setName("omp_offload.skip");
+	launch_bb->setName("omp_offload.launch");
+	launch->moveBefore(launch_term);
+	auto tail = launch_bb->getSingleSuccessor();
+	auto result = PHINode::Create(launch->getType(), 2, "offload.ret", &tail->front());
+	launch->replaceAllUsesWith(result);
+	result->addIncoming(launch, launch_bb);
+	result->addIncoming(ConstantInt::get(launch->getType(), 1), skip_bb);
+	FAM.invalidate(F, PreservedAnalyses::none());
+	assert(!verifyFunction(F, &dbgs()) && "kernel versioning breaks the host function");
+
+	LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << formatv(
+		"A kernel launch in {0} falls back to the host if the trip count is less than {1}\n",
+		F.getName(), threshold));
+
+	return true;
+}
+
+/* ================ Implementation of HostFallbackHintPass ================= */
+/**
+ * @brief check if the host fallback contains the no_offload hint
+ * @details The hints are searched only in the outlined target region that
+ * the fallback calls directly and in the micro tasks it forks.
+ * Other functions called from there may contain hints for other kernels.
+ */
+static bool hasNoOffloadHint(BasicBlock *failed)
+{
+	SmallPtrSet<Function*, 8> visited;
+	SmallVector<Function*> worklist;
+	auto add = [&](Value *V) {
+		auto F = dyn_cast<Function>(V->stripPointerCasts());
+		if (F && !F->isDeclaration() && visited.insert(F).second) {
+			worklist.push_back(F);
+		}
+	};
+
+	for (auto &I : *failed) {
+		if (auto call = dyn_cast<CallBase>(&I)) {
+			add(call->getCalledOperand());
+		}
+	}
+	while (!worklist.empty()) {
+		auto F = worklist.pop_back_val();
+		for (auto &I : instructions(*F)) {
+			if (auto hint_str = KernelHintAnalysisPass::getHintString(I)) {
+				if (hint_str->split('=').first.trim() == HINT_NO_OFFLOAD_KEY) {
+					return true;
+				}
+			}
+			// the micro task is a part of the same region
+			auto call = dyn_cast<CallBase>(&I);
+			auto callee = call ? call->getCalledFunction() : nullptr;
+			if (callee && (callee->getName() == "__kmpc_fork_call" ||
+					callee->getName() == "__kmpc_fork_teams") &&
+					call->getNumArgOperands() > 2) {
+				add(call->getArgOperand(2));
+			}
+		}
+	}
+	return false;
+}
+
+PreservedAnalyses HostFallbackHintPass::run(Module &M, ModuleAnalysisManager &AM)
+{
+	auto &plan = AM.getResult<DataTransferAnalysisPass>(M);
+	auto &FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+
+	SmallVector<std::pair<CallBase*, bool>> launches;
+	for (auto &event : plan.events()) {
+		if (event.getKind() != TransferEvent::Kind::Kernel) continue;
+		auto resident = any_of(event.getEntries(), [](TransferEntry &E) {
+			return E.resident;
+		});
+		launches.push_back(std::make_pair(event.getCall(), resident));
+	}
+
+	bool changed = false;
+	for (auto &item : launches) {
+		auto launch = item.first;
+		auto &F = *(launch->getFunction());
+		auto failed = findHostFallback(launch);
+		if (!failed) continue;
+		if (!hasNoOffloadHint(failed)) continue;
+		if (item.second) {
+			// the host fallback does not see the device copies
+			errs() << formatv(WARN_MSG_PREFIX "ignoring hint \"{0}\" in {1}: "
+						"the kernel uses data resident on the device\n",
+						HINT_NO_OFFLOAD_KEY, F.getName());
+			continue;
+		}
+		// a non-zero return value makes the launch fall back to the host
+		launch->replaceAllUsesWith(ConstantInt::get(launch->getType(), 1));
+		launch->eraseFromParent();
+		FAM.invalidate(F, PreservedAnalyses::none());
+		changed = true;
+		LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << "A kernel launch in "
+					<< F.getName() << " is replaced with the host fallback\n");
+	}
+
+	return changed ? PreservedAnalyses::none() : PreservedAnalyses::all();
+}
@@ -130,26 +130,30 @@ llvm::json::Value AffineAGCompatibility::getConfigAsJson(Instruction *I) const
 {
 
 	auto config_value = config.find(I);
-	json::Object top;
 	if (config_value != config.end()) {
-		if (config_value->second.base != nullptr) {
-			top["base"] = std::move(json::Value(
-				config_value->second.base->getNameOrAsOperand())
-			);
-		} else {
-			top["base"] = std::move(json::Value("unknown"));
-		}
-		json::Array arr;
-		for (auto C : config_value->second.config) {
-
-			arr.push_back(json::Object(
-				{{"start", json::Value(C.start)},
-				 {"step", json::Value(C.step)},
-				 {"count", json::Value(C.count)}}
-			));
-		}
-		top["offset"] = std::move(arr);
+		return configToJson(config_value->second);
+	}
+
+	return json::Object({});
+}
+
+llvm::json::Value AffineAGCompatibility::configToJson(const ConfigTy &C)
+{
+	json::Object top;
+	if (C.base != nullptr) {
+		top["base"] = std::move(json::Value(C.base->getNameOrAsOperand()));
+	} else {
+		top["base"] = std::move(json::Value("unknown"));
+	}
+	json::Array arr;
+	for (auto entry : C.config) {
+		arr.push_back(json::Object(
+			{{"start", json::Value(entry.start)},
+			 {"step", json::Value(entry.step)},
+			 {"count", json::Value(entry.count)}}
+		));
 	}
+	top["offset"] = std::move(arr);
 
 	return std::move(top);
 }
@@ -0,0 +1,166 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /src/Passes/CGRAOmpVerifyPass/BankAssignmentAnalysis.cpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 04:33:18
+*    Last Modified: 17-10-2026 04:33:18
+*/
+#include "BankAssignmentAnalysis.hpp"
+#include "DecoupledAnalysis.hpp"
+#include "CGRAOmpPass.hpp"
+#include "common.hpp"
+
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FormatVariadic.h"
+
+#include <algorithm>
+
+using namespace llvm;
+using namespace CGRAOmp;
+
+#define DEBUG_TYPE "cgraomp"
+static const char *VerboseDebug = DEBUG_TYPE "-verbose";
+
+/* ================= Implementation of BankAssignment ================= */
+Optional<json::Value> BankAssignment::getSlotAsJson(Instruction *I) const
+{
+	if (auto slot = getSlot(I)) {
+		return json::Value(json::Object(
+			{{"bank", json::Value(slot->bank)},
+			 {"port", json::Value(slot->port)}}
+		));
+	}
+	return None;
+}
+
+/* ============= Implementation of BankAssignmentAnalysisPass ============= */
+AnalysisKey BankAssignmentAnalysisPass::Key;
+
+BankAssignmentAnalysisPass::Result BankAssignmentAnalysisPass::run(Loop &L,
+								LoopAnalysisManager &AM,
+								LoopStandardAnalysisResults &AR)
+{
+	Result result;
+
+	auto &MM = AM.getResult<ModelManagerLoopProxy>(L, AR);
+	auto dec_model = dyn_cast<DecoupledCGRA>(MM.getModel());
+	if (!dec_model || !dec_model->hasMemoryBank() ||
+			!isa<AffineAG>(dec_model->getAG())) {
+		return result;
+	}
+	auto &AGC = AM.getResult<VerifyAGCompatiblePass<AffineAGCompatibility>>(L, AR);
+	if (!AGC) {
+		// no need to analyze incompatible kernels
+		return result;
+	}
+	auto &DA = AM.getResult<DecoupledAnalysisPass>(L, AR);
+
+	// collect streams for each array
+	using StreamTy = SmallVector<Instruction*>;
+	MapVector<Value*, SmallVector<StreamTy>> arrays;
+	auto add_access = [&](Instruction *I) {
+		auto C = AGC.getConfig(I);
+		if (!C || !C->valid || !C->base) return;
+		auto &streams = arrays[C->base];
+		if (isa<LoadInst>(I)) {
+			// loads of the same stream are served at once
+			for (auto &S : streams) {
+				if (isa<LoadInst>(S.front()) &&
+						isSameStream(*C, *AGC.getConfig(S.front()))) {
+					S.emplace_back(I);
+					return;
+				}
+			}
+		}
+		streams.emplace_back(StreamTy({I}));
+	};
+	for (auto load : DA.loads()) {
+		add_access(load);
+	}
+	for (auto store : DA.stores()) {
+		add_access(store);
+	}
+
+	// arrays with more streams first
+	SmallVector<Value*> order;
+	for (auto &entry : arrays) {
+		order.emplace_back(entry.first);
+	}
+	std::stable_sort(order.begin(), order.end(), [&](Value *lhs, Value *rhs) {
+		return arrays[lhs].size() > arrays[rhs].size();
+	});
+
+	int ports = dec_model->getPortsPerBank();
+	SmallVector<int> used(dec_model->getNumBanks(), 0);
+	int conflicts = 0;
+	for (auto base : order) {
+		// the least loaded bank
+		int bank = std::min_element(used.begin(), used.end()) - used.begin();
+		result.setArrayBank(base, bank);
+		for (auto &S : arrays[base]) {
+			if (used[bank] >= ports) {
+				// it must be serialized with another stream
+				conflicts++;
+			}
+			BankAssignment::SlotTy slot = {bank, used[bank] % ports};
+			for (auto I : S) {
+				result.assign(I, slot);
+			}
+			used[bank]++;
+		}
+		DEBUG_WITH_TYPE(VerboseDebug, base->printAsOperand(dbgs() 
+			<< DBG_DEBUG_PREFIX << formatv("bank {0}: ", bank));
+			dbgs() << formatv(" ({0} streams)\n", arrays[base].size()));
+	}
+	result.setNumConflicts(conflicts);
+
+	LLVM_DEBUG(
+		if (conflicts > 0) {
+			dbgs() << WARN_DEBUG_PREFIX << conflicts 
+				<< " streams share a port of memory bank with others\n";
+		}
+	);
+
+	return result;
+}
+
+bool BankAssignmentAnalysisPass::isSameStream(const ConfigTy &A,
+												const ConfigTy &B)
+{
+	if (A.base != B.base || A.config.size() != B.config.size()) return false;
+	for (unsigned i = 0; i < A.config.size(); i++) {
+		if (A.config[i].start != B.config[i].start ||
+				A.config[i].step != B.config[i].step ||
+				A.config[i].count != B.config[i].count) {
+			return false;
+		}
+	}
+	return true;
+}
+
+#undef DEBUG_TYPE
@@ -28,6 +28,7 @@
 *    Last Modified: 17-07-2022 17:28:59
 */
 #include "LoopDependencyAnalysis.hpp"
+#include "CGRAOmpPass.hpp"
 #include "OptionPlugin.hpp"
 #include "common.hpp"
 
@@ -40,6 +41,9 @@
 #include "llvm/Analysis/MemorySSA.h"
 #include "llvm/Analysis/LoopAccessAnalysis.h"
 #include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/ADT/STLExtras.h"
+
+#include <tuple>
 
 using namespace llvm;
 using namespace CGRAOmp;
@@ -71,7 +75,23 @@ LoopDependencyAnalysisPass::Result LoopDependencyAnalysisPass::run(Loop &L, Loop
 			auto indvar = nest->getInductionVariable(AR.SE);
 			if (auto step = IDV.getConstIntStepValue()) {
 				indvar_set.insert(indvar);
-				auto IVDep = new InductionVariableDependency(indvar, carried, start, step);
+				// loop bound is used when it is mapped to a loop counter
+				// it must be fixed during the loop and the trip count must be computable
+				Value *bound = nullptr;
+				auto pred = CmpInst::BAD_ICMP_PREDICATE;
+				if (auto LB = nest->getBounds(AR.SE)) {
+					auto final_val = &(LB->getFinalIVValue());
+					if (nest->isLoopInvariant(final_val) &&
+							!isa<SCEVCouldNotCompute>(AR.SE.getBackedgeTakenCount(nest))) {
+						bound = final_val;
+						pred = LB->getCanonicalPredicate();
+					}
+				}
+				int nest_level = nest->getLoopDepth() - L.getLoopDepth();
+				auto IVDep = new InductionVariableDependency(indvar, carried,
+								start, step, bound, nest->getLatchCmpInst(),
+								nest_level);
+				IVDep->setBoundPredicate(pred);
 				result.add_idv_dep(IVDep);
 			} else {
 				// not constant step
@@ -112,6 +132,16 @@ LoopDependencyAnalysisPass::Result LoopDependencyAnalysisPass::run(Loop &L, Loop
 
 	// check data dependency via memory
 	// considering only RAW hazard
+	// the distance threshold and the register budget are derived from
+	// the CGRA model unless specified
+	int dist_threshold = OptMemoryDependencyDistanceThreshold;
+	int reg_budget = INT_MAX;
+	if (OptMemoryDependencyDistanceThreshold.getNumOccurrences() == 0) {
+		auto &MM = AM.getResult<ModelManagerLoopProxy>(L, AR);
+		dist_threshold = MM.getModel()->getMaxDependencyDistance();
+		reg_budget = MM.getModel()->getRegisterBudget();
+	}
+	SmallVector<std::tuple<StoreInst*, LoadInst*, int>> candidates;
 	auto &LAI = AM.getResult<LoopAccessAnalysis>(L, AR);
 	auto checker = LAI.getDepChecker();
 	auto deps = checker.getDependences();
@@ -124,13 +154,11 @@ LoopDependencyAnalysisPass::Result LoopDependencyAnalysisPass::run(Loop &L, Loop
 
 			auto Dist = getDistance(def, use, AR.SE);
 			if (Dist.hasValue()) {
-				if (*Dist <= OptMemoryDependencyDistanceThreshold) {
-					// treat it as data dependency
-					auto MDep = new MemoryLoopDependency(def, use, *Dist);
-					result.add_mem_dep(MDep);
+				if (*Dist <= dist_threshold) {
+					candidates.emplace_back(def, use, *Dist);
 				} else {
 					LLVM_DEBUG(
-						dbgs() << INFO_DEBUG_PREFIX << "detect loop-carried dependency via memory access but distance "  << *Dist << " is larger than the threshold " << OptMemoryDependencyDistanceThreshold << "\n";
+						dbgs() << INFO_DEBUG_PREFIX << "detect loop-carried dependency via memory access but distance "  << *Dist << " is larger than the threshold " << dist_threshold << "\n";
 					);
 				}
 			} else {
@@ -146,6 +174,29 @@ LoopDependencyAnalysisPass::Result LoopDependencyAnalysisPass::run(Loop &L, Loop
 		}
 	}
 
+	// a dependency with distance d occupies d-1 delay registers
+	// shorter ones are taken first to keep as many dependencies as possible
+	llvm::stable_sort(candidates, [](const auto &lhs, const auto &rhs) {
+		return std::get<2>(lhs) < std::get<2>(rhs);
+	});
+	int used_regs = 0;
+	for (auto &cand : candidates) {
+		StoreInst *def;
+		LoadInst *use;
+		int dist;
+		std::tie(def, use, dist) = cand;
+		if (dist - 1 > reg_budget - used_regs) {
+			LLVM_DEBUG(
+				dbgs() << INFO_DEBUG_PREFIX << "detect loop-carried dependency via memory access but distance "  << dist << " exceeds the remaining register budget " << reg_budget - used_regs << "\n";
+			);
+			continue;
+		}
+		used_regs += dist - 1;
+		// treat it as data dependency
+		auto MDep = new MemoryLoopDependency(def, use, dist);
+		result.add_mem_dep(MDep);
+	}
+
 	return result;
 }
 
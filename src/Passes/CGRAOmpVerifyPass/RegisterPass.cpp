@@ -33,6 +33,8 @@
 #include "DecoupledAnalysis.hpp"
 #include "AGVerifyPass.hpp"
 #include "LoopDependencyAnalysis.hpp"
+#include "SlidingWindowAnalysis.hpp"
+#include "BankAssignmentAnalysis.hpp"
 
 using namespace CGRAOmp;
 
@@ -56,7 +58,7 @@ static void registerLoopAnalyses(LoopAnalysisManager &LAM)
 
 }
 
-static void registerVerifyPasses(PassBuilder &PB)
+void CGRAOmp::registerVerifyPasses(PassBuilder &PB)
 {
 	PB.registerAnalysisRegistrationCallback(registerFunctionAnalyses);
 	PB.registerAnalysisRegistrationCallback(registerLoopAnalyses);
@@ -0,0 +1,218 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /src/Passes/CGRAOmpVerifyPass/SlidingWindowAnalysis.cpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 04:24:07
+*    Last Modified: 17-10-2026 04:24:07
+*/
+#include "SlidingWindowAnalysis.hpp"
+#include "DecoupledAnalysis.hpp"
+#include "common.hpp"
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FormatVariadic.h"
+
+using namespace llvm;
+using namespace CGRAOmp;
+
+#define DEBUG_TYPE "cgraomp"
+static const char *VerboseDebug = DEBUG_TYPE "-verbose";
+
+/* ============= Implementation of SlidingWindowAnalysisPass ============= */
+AnalysisKey SlidingWindowAnalysisPass::Key;
+
+SlidingWindowAnalysisPass::Result SlidingWindowAnalysisPass::run(Loop &L,
+								LoopAnalysisManager &AM,
+								LoopStandardAnalysisResults &AR)
+{
+	Result result;
+
+	auto &AGC = AM.getResult<VerifyAGCompatiblePass<AffineAGCompatibility>>(L, AR);
+	if (!AGC) {
+		// no need to analyze incompatible kernels
+		return result;
+	}
+	auto &DA = AM.getResult<DecoupledAnalysisPass>(L, AR);
+
+	// collect loads with a valid config
+	SmallVector<LoadInst*> loads;
+	for (auto inst : DA.loads()) {
+		if (auto load = dyn_cast<LoadInst>(inst)) {
+			auto C = AGC.getConfig(load);
+			if (C && C->valid && C->base && !C->config.empty()) {
+				loads.emplace_back(load);
+			}
+		}
+	}
+
+	SmallPtrSet<LoadInst*, 32> grouped;
+	for (auto A : loads) {
+		if (grouped.contains(A)) continue;
+		auto CA = AGC.getConfig(A);
+		auto step = CA->config.back().step;
+		if (step == 0) continue;
+
+		// find loads having the same base and shape
+		SmallVector<LoadInst*> members;
+		members.emplace_back(A);
+		for (auto B : loads) {
+			if (A == B || grouped.contains(B)) continue;
+			auto CB = AGC.getConfig(B);
+			if (CA->base == CB->base && isSameShape(*CA, *CB)) {
+				// offsets must be aligned to the step
+				if ((getOffset(*CA) - getOffset(*CB)) % step == 0) {
+					members.emplace_back(B);
+				}
+			}
+		}
+		if (members.size() < 2) continue;
+
+		// the leader is the load reading the data earliest
+		// i.e., the largest offset in the direction of the step
+		int64_t dir = step > 0 ? 1 : -1;
+		auto leader = *std::max_element(members.begin(), members.end(),
+			[&](LoadInst *lhs, LoadInst *rhs) {
+				return getOffset(*AGC.getConfig(lhs)) * dir <
+						getOffset(*AGC.getConfig(rhs)) * dir;
+			});
+		auto stream = *AGC.getConfig(leader);
+		auto ext = linearize(stream);
+		if (!ext) {
+			LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << members.size()
+				<< " loads share the same base but the stream cannot be linearized\n");
+			continue;
+		}
+
+		ReuseGroup G(leader, stream);
+		G.setRowExtension(*ext);
+		auto lead_offset = getOffset(*AGC.getConfig(leader));
+		for (auto member : members) {
+			grouped.insert(member);
+			if (member == leader) continue;
+			int delay = (lead_offset - getOffset(*AGC.getConfig(member))) / step;
+			G.addTap(member, delay);
+		}
+
+		// the row extension covers only the delays within a row
+		// the rest is prefilled by starting the stream earlier
+		int warmup = std::max(G.getDepth() - *ext, 0);
+		if (warmup > 0) {
+			prefill(stream, warmup);
+			G.setStreamConfig(stream);
+			G.setWarmup(warmup);
+		}
+
+		LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << formatv(
+			"{0} loads are reusable via a line buffer (depth {1}, warm-up {2})\n",
+			members.size(), G.getDepth(), G.getWarmup()));
+		DEBUG_WITH_TYPE(VerboseDebug,
+			for (auto tap : G.getTaps()) {
+				tap.first->print(dbgs() << DBG_DEBUG_PREFIX);
+				dbgs() << " delay: " << tap.second << "\n";
+			});
+
+		result.add_group(std::move(G));
+	}
+
+	return result;
+}
+
+bool SlidingWindowAnalysisPass::isSameShape(const ConfigTy &A, const ConfigTy &B)
+{
+	if (A.config.size() != B.config.size()) return false;
+	for (unsigned i = 0; i < A.config.size(); i++) {
+		if (A.config[i].step != B.config[i].step ||
+				A.config[i].count != B.config[i].count) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int64_t SlidingWindowAnalysisPass::getOffset(const ConfigTy &C)
+{
+	int64_t offset = 0;
+	for (auto entry : C.config) {
+		offset += entry.start;
+	}
+	return offset;
+}
+
+/**
+ * @details The stream is linear if the step of each dimension equals to
+ * the product of step and count of the inner dimension.
+ * Only the innermost dimension can be extended to satisfy it.
+ * The extended iterations are placed before the original ones of each row,
+ * so they only cover the delays up to the extension.
+ * Longer delays are covered by prefill().
+ */
+Optional<int> SlidingWindowAnalysisPass::linearize(ConfigTy &C)
+{
+	int n = C.config.size();
+	for (auto entry : C.config) {
+		// unknown trip count
+		if (entry.count <= 0) return None;
+	}
+	if (n == 1) return 0;
+
+	for (int i = 0; i < n - 2; i++) {
+		if (C.config[i].step != C.config[i + 1].step * C.config[i + 1].count) {
+			return None;
+		}
+	}
+
+	auto &inner = C.config[n - 1];
+	auto outer_step = C.config[n - 2].step;
+	if (outer_step % inner.step != 0) return None;
+	int64_t width = outer_step / inner.step;
+	if (width < inner.count) return None;
+
+	int ext = width - inner.count;
+	inner.count = width;
+	inner.start -= ext * inner.step;
+	return ext;
+}
+
+/**
+ * @details The linearized stream is flattened into a single dimension and
+ * its start is moved backward by @p elems elements.
+ * All the addresses prefilled are read by the taps in the original kernel
+ * (the earliest tap at the first iteration), so no extra data is accessed.
+ */
+void SlidingWindowAnalysisPass::prefill(ConfigTy &C, int elems)
+{
+	int64_t step = C.config.back().step;
+	int64_t total = 1;
+	for (auto entry : C.config) {
+		total *= entry.count;
+	}
+	int64_t start = getOffset(C) - elems * step;
+	C.config.clear();
+	C.config.push_back({start, step, total + elems});
+}
+
+#undef DEBUG_TYPE
@@ -50,6 +50,7 @@
 #include "AGVerifyPass.hpp"
 #include "LoopDependencyAnalysis.hpp"
 #include "Utils.hpp"
+#include "KernelHint.hpp"
 
 #include <system_error>
 #include <functional>
@@ -71,6 +72,8 @@ template<>
 const char* DecoupleAnalysisResult::name = "Memory access decoupling";
 template<>
 const char* InterLoopDependencyAnalysisResult::name = "Inter loop dependency";
+template<>
+const char* PEDemandResult::name = "PE class demand";
 
 
 
@@ -118,8 +121,7 @@ VerifyInstAvailabilityPass<DecoupledVerifyPass>::checkUnsupportedInst(Loop& L,
 	auto LN = LoopNest::getLoopNest(L, AR.SE);
 	auto innermost = LN->getInnermostLoop();
 
-	auto &MM = AM.getResult<ModelManagerLoopProxy>(L, AR);
-	auto *model = MM.getModel();
+	auto &IM = getInstMapInfo(L, AM, AR);
 
 	InstList unsupported;
 
@@ -127,8 +129,7 @@ VerifyInstAvailabilityPass<DecoupledVerifyPass>::checkUnsupportedInst(Loop& L,
 
 	for (Value *v : DA.get_comps()) {
 		if (auto *inst = dyn_cast<Instruction>(v)) {
-			auto *imap = model->isSupported(inst);
-			if (!imap) {
+			if (!IM.isSupported(inst)) {
 				unsupported.emplace_back(inst);
 			}
 		} else {
@@ -190,6 +191,10 @@ VerifyResult TimeMultiplexedVerifyPass::run(Function &F, FunctionAnalysisManager
 	auto model = MM.getModel();
 	auto tm_model = model->asDerived<TMCGRA>();
 
+	if (isExcludedByHint(F, AM)) {
+		return result;
+	}
+
 	// ensure OmpStaticShecudleAnalysis result is cached  
 	auto SI = AM.getResult<OmpStaticShecudleAnalysis>(F);
 	if (!SI) {
@@ -198,6 +203,9 @@ VerifyResult TimeMultiplexedVerifyPass::run(Function &F, FunctionAnalysisManager
 		Exit(make_error<StringError>("Fail to find OpenMP scheduling info", EC));
 	}
 
+	// ensure InstMapAnalysisPass result is cached for instruction availability
+	auto &IM = AM.getResult<InstMapAnalysisPass>(F);
+
 	// setup loop analysis manager
 	auto AR = getLSAR(F, AM);
  	auto &LAM = AM.getResult<LoopAnalysisManagerFunctionProxy>(F).getManager();
@@ -257,9 +265,24 @@ VerifyResult TimeMultiplexedVerifyPass::run(Function &F, FunctionAnalysisManager
 		}
 		lvr.setResult(&inst_avail);
 
+		// verify the operation demand for each PE class
+		if (model->hasPEClasses()) {
+			SmallVector<Instruction*> insts;
+			for (auto &BB : L->getBlocks()) {
+				for (auto &I : *BB) {
+					if (!except_inst.count(&I)) {
+						insts.push_back(&I);
+					}
+				}
+			}
+			lvr.setResult(verifyPEDemand(model, IM, insts));
+		}
+
 		// if the kernel passes all the verifications, it is registered
 		if (lvr) {
 			result.registerKernel(L, lvr);
+		} else {
+			result.registerRejectedKernel(L, lvr);
 		}
 		remarkEmitter(F, *L, lvr, AM);
 	}
@@ -282,6 +305,10 @@ VerifyResult DecoupledVerifyPass::run(Function &F, FunctionAnalysisManager &AM)
 	auto model = MM.getModel();
 	auto dec_model = model->asDerived<DecoupledCGRA>();
 
+	if (isExcludedByHint(F, AM)) {
+		return result;
+	}
+
 	auto MAM = AM.getResult<ModuleAnalysisManagerFunctionProxy>(F);
 
 	// ensure OmpStaticShecudleAnalysis result is cached for DecoupledAnalysis
@@ -292,6 +319,9 @@ VerifyResult DecoupledVerifyPass::run(Function &F, FunctionAnalysisManager &AM)
 		Exit(make_error<StringError>("Fail to find OpenMP scheduling info", EC));
 	}
 
+	// ensure InstMapAnalysisPass result is cached for instruction availability
+	auto &IM = AM.getResult<InstMapAnalysisPass>(F);
+
 	// setup loop analysis manager
 	auto AR = getLSAR(F, AM);
  	auto &LPM = AM.getResult<LoopAnalysisManagerFunctionProxy>(F).getManager();
@@ -368,6 +398,17 @@ VerifyResult DecoupledVerifyPass::run(Function &F, FunctionAnalysisManager &AM)
 		}
 		lvr.setResult(&inst_avail);
 
+		// verify the operation demand for each PE class
+		if (model->hasPEClasses()) {
+			SmallVector<Instruction*> insts;
+			for (auto V : DA.get_comps()) {
+				auto *I = dyn_cast<Instruction>(V);
+				if (I && !except_inst.count(I)) {
+					insts.push_back(I);
+				}
+			}
+			lvr.setResult(verifyPEDemand(model, IM, insts));
+		}
 
 		// verify conditional parts
 		
@@ -385,6 +426,8 @@ VerifyResult DecoupledVerifyPass::run(Function &F, FunctionAnalysisManager &AM)
 		// if the kernel passes all the verifications, it is registered
 		if (lvr) {
 			result.registerKernel(L, lvr);
+		} else {
+			result.registerRejectedKernel(L, lvr);
 		}
 		remarkEmitter(F, *L, lvr, AM);
 	}
@@ -454,10 +497,13 @@ void VerifyPassBase<DerivedT>::remarkEmitter(Function &F,  Loop &L,
 	auto &ORE = AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
 	
 	if (R) {
+		auto AR = getLSAR(F, AM);
 		ORE.emit([&]() {
 			auto Remark = OptimizationRemark(CGRAOMP_PASS_NAME, "valid kernel",
 					L.getStartLoc(), L.getHeader());
-			Remark << ore::NV("Loop", L.getName());
+			Remark << ore::NV("Loop", L.getName())
+					<< ore::NV("Weight", (float)getLoopWeight(L, AR))
+					<< ore::NV("Profiled", F.hasProfileData());
 			return Remark;
 		});
 	} else {
@@ -476,6 +522,77 @@ void VerifyPassBase<DerivedT>::remarkEmitter(Function &F,  Loop &L,
 
 }
 
+template<typename DerivedT>
+bool VerifyPassBase<DerivedT>::isExcludedByHint(Function &F,
+										FunctionAnalysisManager &AM)
+{
+	auto &MAMProxy = AM.getResult<ModuleAnalysisManagerFunctionProxy>(F);
+	auto *hints = MAMProxy.getCachedResult<KernelHintAnalysisPass>(*F.getParent());
+	if (!hints) {
+		return false;
+	}
+	auto hint = hints->getHint(&F);
+	if (!hint) {
+		return false;
+	}
+
+	std::string reason;
+	if (hint->no_offload) {
+		reason = "no_offload";
+	} else if (hint->model) {
+		auto MM = AM.getResult<ModelManagerFunctionProxy>(F);
+		// the preference is effective only if the model is loaded
+		bool loaded = false;
+		for (unsigned i = 0; i < MM.getNumModels(); i++) {
+			loaded |= (MM.getModelName(i) == *hint->model);
+		}
+		if (!loaded) {
+			LLVM_DEBUG(dbgs() << WARN_DEBUG_PREFIX << "preferred model "
+						<< *hint->model << " for " << F.getName()
+						<< " is not loaded\n");
+		} else if (MM.getModelName() != *hint->model) {
+			reason = formatv("model={0}", *hint->model);
+		}
+	}
+	if (reason.empty()) {
+		return false;
+	}
+
+	LLVM_DEBUG(dbgs() << INFO_DEBUG_PREFIX << F.getName()
+				<< " is excluded by the hint " << reason << "\n");
+	auto &ORE = AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
+	ORE.emit([&]() {
+		return OptimizationRemarkMissed(CGRAOMP_PASS_NAME, "excluded kernel",
+					F.getSubprogram(), &F.getEntryBlock())
+				<< ore::NV("Function", F.getName())
+				<< ore::NV("Hint", reason);
+	});
+	return true;
+}
+
+template<typename DerivedT>
+PEDemandResult* VerifyPassBase<DerivedT>::verifyPEDemand(CGRAModel *model,
+							InstMapInfo &IM, ArrayRef<Instruction*> insts)
+{
+	// count the operations for each map name
+	StringMap<unsigned> demand;
+	for (auto I : insts) {
+		if (IM.isSupported(I)) {
+			demand[IM.getMapName(I)]++;
+		}
+	}
+
+	PEDemandResult *PDR;
+	if (auto reason = model->checkPEDemand(demand)) {
+		LLVM_DEBUG(dbgs() << WARN_DEBUG_PREFIX << *reason << "\n");
+		PDR = new PEDemandResult(*reason);
+		PDR->setVio();
+	} else {
+		PDR = new PEDemandResult("All operations fit the PE classes");
+	}
+	return PDR;
+}
+
 
 
 /* ================== Implementation of VerifyModulePass ================== */
@@ -519,6 +636,11 @@ PreservedAnalyses VerifyModulePass::run(Module &M, ModuleAnalysisManager &AM)
 		}
 
 		valid_kernels += result->getNumKernels();
+
+		// statistics for the model summary
+		auto &S = MM.getSummary();
+		S.kernels++;
+		S.verified += result->getNumKernels();
 	}
 
 
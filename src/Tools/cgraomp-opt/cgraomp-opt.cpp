@@ -0,0 +1,196 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /src/Tools/cgraomp-opt/cgraomp-opt.cpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 05:24:36
+*    Last Modified: 17-10-2026 05:24:36
+*/
+#include "common.hpp"
+#include "CGRAOmpPass.hpp"
+#include "VerifyPass.hpp"
+#include "CGRAOmpAnnotationPass.hpp"
+
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LLVMRemarkStreamer.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Passes/StandardInstrumentations.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <memory>
+
+using namespace llvm;
+using namespace CGRAOmp;
+
+#define DEFAULT_PREOPT_PIPELINE CGRAOMP_PREOPT_PASS_NAME "<O2>"
+#define DEFAULT_AA_PIPELINE "basic-aa,scoped-noalias-aa,tbaa,globals-aa,scev-aa"
+
+static cl::OptionCategory DriverCategory("cgraomp-opt options");
+
+static cl::opt<std::string> InputFilename(cl::Positional,
+	cl::desc("<device IR file (.ll or .bc)>"), cl::init("-"),
+	cl::value_desc("filename"), cl::cat(DriverCategory));
+
+static cl::opt<std::string> OutputFilename("o",
+	cl::desc("Override output filename"), cl::value_desc("filename"),
+	cl::init("-"), cl::cat(DriverCategory));
+
+static cl::opt<bool> OutputAssembly("S",
+	cl::desc("Write output as LLVM assembly"), cl::cat(DriverCategory));
+
+static cl::opt<bool> DisableOutput("disable-output",
+	cl::desc("Do not write the resulting IR"), cl::cat(DriverCategory));
+
+static cl::opt<bool> NoVerify("disable-verify",
+	cl::desc("Do not run the verifier on the input and output"),
+	cl::cat(DriverCategory));
+
+static cl::opt<std::string> PreOptPipeline("preopt-pipeline",
+	cl::desc("A textual description of the pre-optimization pipeline "
+			"(empty to skip it)"),
+	cl::init(DEFAULT_PREOPT_PIPELINE), cl::cat(DriverCategory));
+
+static cl::opt<std::string> AAPipeline("aa-pipeline",
+	cl::desc("A textual description of the alias analysis pipeline"),
+	cl::init(DEFAULT_AA_PIPELINE), cl::cat(DriverCategory));
+
+static cl::opt<bool> DebugPM("debug-pass-manager",
+	cl::desc("Print pass management debugging information"),
+	cl::cat(DriverCategory));
+
+static cl::opt<std::string> RemarksFilename("pass-remarks-output",
+	cl::desc("Output filename for pass remarks"),
+	cl::value_desc("filename"), cl::cat(DriverCategory));
+
+static cl::opt<std::string> RemarksPasses("pass-remarks-filter",
+	cl::desc("Only record optimization remarks from passes whose "
+			"names match the given regular expression"),
+	cl::value_desc("regex"), cl::cat(DriverCategory));
+
+static cl::opt<std::string> RemarksFormat("pass-remarks-format",
+	cl::desc("The format used for serializing remarks (default: YAML)"),
+	cl::value_desc("format"), cl::init("yaml"), cl::cat(DriverCategory));
+
+int main(int argc, char **argv)
+{
+	InitLLVM X(argc, argv);
+	cl::ParseCommandLineOptions(argc, argv,
+		"CGRAOmp driver: pre-optimization, kernel verification and "
+		"DFG extraction of the device IR in a single process\n");
+
+	ExitOnError Exit(ERR_MSG_PREFIX);
+	LLVMContext Context;
+
+	// read the unbundled device IR only once
+	SMDiagnostic Err;
+	std::unique_ptr<Module> M = parseIRFile(InputFilename, Err, Context);
+	if (!M) {
+		Err.print(argv[0], errs());
+		return 1;
+	}
+	if (!NoVerify && verifyModule(*M, &errs())) {
+		errs() << formatv(ERR_MSG_PREFIX "{0}: input module is broken\n",
+							InputFilename);
+		return 1;
+	}
+
+	auto RemarksFile = Exit(setupLLVMOptimizationRemarks(Context,
+								RemarksFilename, RemarksPasses, RemarksFormat,
+								false));
+
+	std::unique_ptr<ToolOutputFile> Out;
+	if (!DisableOutput) {
+		std::error_code EC;
+		Out.reset(new ToolOutputFile(OutputFilename, EC,
+					OutputAssembly ? sys::fs::F_Text : sys::fs::F_None));
+		if (EC) {
+			errs() << formatv(ERR_MSG_PREFIX "{0}: {1}\n",
+								OutputFilename, EC.message());
+			return 1;
+		}
+	}
+
+	PassInstrumentationCallbacks PIC;
+	StandardInstrumentations SI(DebugPM);
+	SI.registerCallbacks(PIC);
+
+	PassBuilder PB(DebugPM, nullptr, PipelineTuningOptions(), None, &PIC);
+	// same order as the plugins are loaded by cgraomp-cc
+	registerAnnotationPasses(PB);
+	registerCGRAOmpPasses(PB);
+	registerVerifyPasses(PB);
+
+	LoopAnalysisManager LAM(DebugPM);
+	FunctionAnalysisManager FAM(DebugPM);
+	CGSCCAnalysisManager CGAM(DebugPM);
+	ModuleAnalysisManager MAM(DebugPM);
+
+	AAManager AA;
+	Exit(PB.parseAAPipeline(AA, AAPipeline));
+	FAM.registerPass([&] { return std::move(AA); });
+
+	PB.registerModuleAnalyses(MAM);
+	PB.registerCGSCCAnalyses(CGAM);
+	PB.registerFunctionAnalyses(FAM);
+	PB.registerLoopAnalyses(LAM);
+	PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+	// pre-optimization -> cgraomp pipeline in the same pass manager
+	// so that the model and the analyses are set up only once
+	ModulePassManager MPM(DebugPM);
+	if (!PreOptPipeline.empty()) {
+		Exit(PB.parsePassPipeline(MPM, PreOptPipeline, DebugPM));
+	}
+	Exit(PB.parsePassPipeline(MPM, CGRAOMP_PASS_NAME, DebugPM));
+	if (!NoVerify) {
+		MPM.addPass(VerifierPass());
+	}
+
+	MPM.run(*M, MAM);
+
+	if (Out) {
+		if (OutputAssembly) {
+			M->print(Out->os(), nullptr);
+		} else {
+			WriteBitcodeToFile(*M, Out->os());
+		}
+		Out->keep();
+	}
+	if (RemarksFile) {
+		RemarksFile->keep();
+	}
+
+	return 0;
+}
@@ -0,0 +1,336 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /test/benchmark/bench_map_condition.cpp
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 06:17:29
+*    Last Modified: 17-10-2026 06:17:29
+*/
+#include "common.hpp"
+#include "CGRAInstMap.hpp"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <functional>
+
+using namespace llvm;
+using namespace CGRAOmp;
+
+static cl::opt<unsigned> Iterations("iterations",
+	cl::desc("Number of times the instructions are classified"),
+	cl::init(10000));
+
+static cl::opt<unsigned> Copies("copies",
+	cl::desc("Number of copies of the instruction mix in the function"),
+	cl::init(64));
+
+/**
+ * @struct CondSpec
+ * @brief a mapping condition as it is written in the model config
+ */
+struct CondSpec {
+	StringRef map;
+	SmallVector<std::string> flags;
+	Optional<int> use_int;
+	Optional<double> use_double;
+	bool isLeft = false;
+	StringRef pred;
+};
+
+/**
+ * @class LegacyMapCondition
+ * @brief the mapping condition before it is compiled into the flat form
+ * @details Each flag is looked up in a table of std::function getters
+ * and a constant operand is checked by a type-erased matcher.
+ * The operand index of an "lhs" constant is fixed so that the results are comparable.
+ */
+class LegacyMapCondition {
+	public:
+		LegacyMapCondition(const CondSpec &spec) {
+			for (auto &f : spec.flags) {
+				flag_list.push_back(FlagGetter.find(f)->first());
+			}
+			unsigned const_operand = spec.isLeft ? 0 : 1;
+			if (spec.use_int) {
+				int use_int = *spec.use_int;
+				anyConst = false;
+				match_use = [=](Instruction *I) {
+					if (const_operand < I->getNumOperands()) {
+						if (auto cint = dyn_cast<ConstantInt>(I->getOperand(const_operand))) {
+							return use_int == cint->getSExtValue();
+						}
+					}
+					return false;
+				};
+			} else if (spec.use_double) {
+				double use_double = *spec.use_double;
+				anyConst = false;
+				match_use = [=](Instruction *I) {
+					if (const_operand < I->getNumOperands()) {
+						if (auto cfp = dyn_cast<ConstantFP>(I->getOperand(const_operand))) {
+							double v = cfp->getValueAPF().convertToDouble();
+							return (fabs(use_double - v) <= DBL_EPSILON
+								* fmax(1, fmax(fabs(use_double), fabs(v))));
+						}
+					}
+					return false;
+				};
+			}
+			if (!spec.pred.empty()) {
+				cmp_pred = PredMap.find(spec.pred)->second;
+				anyPred = false;
+			}
+		}
+
+		bool match(Instruction *I) {
+			for (auto flag : flag_list) {
+				if (!(FlagGetter[flag])(I)) {
+					return false;
+				}
+			}
+			if (!anyConst && !match_use(I)) {
+				return false;
+			}
+			if (!anyPred) {
+				if (auto cmp_inst = dyn_cast<CmpInst>(I)) {
+					if (cmp_inst->getPredicate() != cmp_pred) return false;
+				} else {
+					return false;
+				}
+			}
+			return true;
+		}
+
+	private:
+		SmallVector<StringRef> flag_list;
+		std::function<bool(Instruction*)> match_use;
+		bool anyConst = true;
+		CmpInst::Predicate cmp_pred;
+		bool anyPred = true;
+
+		static StringMap<std::function<bool(Instruction*)>> FlagGetter;
+		static StringMap<CmpInst::Predicate> PredMap;
+};
+
+#define FLAG_GETTER(FLAG, ISA, GETTER) std::make_pair(FLAG, [](Instruction *I) { \
+	if (isa<ISA>(I)) { \
+		return I->GETTER(); \
+	} else { \
+		return false;\
+	} \
+})
+
+StringMap<std::function<bool(Instruction*)>> LegacyMapCondition::FlagGetter({
+	FLAG_GETTER("nuw", OverflowingBinaryOperator, hasNoUnsignedWrap),
+	FLAG_GETTER("nsw", OverflowingBinaryOperator, hasNoSignedWrap),
+	FLAG_GETTER("exact", PossiblyExactOperator, isExact),
+	FLAG_GETTER("fast", FPMathOperator, isFast),
+	FLAG_GETTER("nnan", FPMathOperator, hasNoNaNs),
+	FLAG_GETTER("contract", FPMathOperator, hasAllowContract),
+});
+
+StringMap<CmpInst::Predicate> LegacyMapCondition::PredMap({
+	std::make_pair("slt", CmpInst::Predicate::ICMP_SLT),
+	std::make_pair("eq", CmpInst::Predicate::ICMP_EQ),
+	std::make_pair("olt", CmpInst::Predicate::FCMP_OLT),
+});
+
+/**
+ * @brief conditions used in the benchmark
+ * They cover the flags, the constant operands and the predicates.
+ */
+static SmallVector<CondSpec> getCondSpecs()
+{
+	SmallVector<CondSpec> specs;
+	auto add = [&](StringRef map) -> CondSpec& {
+		specs.emplace_back();
+		specs.back().map = map;
+		return specs.back();
+	};
+	add("add_nsw").flags = {"nsw"};
+	add("add_nuw_nsw").flags = {"nuw", "nsw"};
+	add("sdiv_exact").flags = {"exact"};
+	add("fadd_fast").flags = {"fast"};
+	add("fmul_nnan_contract").flags = {"nnan", "contract"};
+	add("mul2").use_int = 2;
+	add("rsub1").use_int = 1;
+	specs.back().isLeft = true;
+	add("fmul_half").use_double = 0.5;
+	add("icmp_slt").pred = "slt";
+	add("icmp_eq").pred = "eq";
+	add("fcmp_olt").pred = "olt";
+	auto &shl = add("shl1_nsw");
+	shl.flags = {"nsw"};
+	shl.use_int = 1;
+	return specs;
+}
+
+/**
+ * @brief make a function with a mix of instructions to be classified
+ */
+static Function* makeInstructionMix(Module &M, unsigned copies)
+{
+	auto &Ctx = M.getContext();
+	auto I32 = Type::getInt32Ty(Ctx);
+	auto F32 = Type::getFloatTy(Ctx);
+	auto FTy = FunctionType::get(Type::getVoidTy(Ctx), {I32, I32, F32, F32}, false);
+	auto F = Function::Create(FTy, GlobalValue::ExternalLinkage, "mix", M);
+	auto BB = BasicBlock::Create(Ctx, "entry", F);
+	IRBuilder<> B(BB);
+	Value *a = F->getArg(0), *b = F->getArg(1);
+	Value *x = F->getArg(2), *y = F->getArg(3);
+	FastMathFlags fast;
+	fast.setFast();
+	FastMathFlags nnan_contract;
+	nnan_contract.setNoNaNs();
+	nnan_contract.setAllowContract(true);
+
+	for (unsigned i = 0; i < copies; i++) {
+		B.CreateAdd(a, b, "", false, true);
+		B.CreateAdd(a, b, "", true, true);
+		B.CreateSub(a, b);
+		B.CreateMul(a, B.getInt32(2));
+		B.CreateSub(B.getInt32(1), b);
+		B.CreateShl(a, B.getInt32(1), "", false, true);
+		B.CreateSDiv(a, b, "", true);
+		B.CreateICmpSLT(a, b);
+		B.CreateICmpEQ(a, b);
+		B.setFastMathFlags(fast);
+		B.CreateFAdd(x, y);
+		B.setFastMathFlags(nnan_contract);
+		B.CreateFMul(x, y);
+		B.clearFastMathFlags();
+		B.CreateFMul(x, ConstantFP::get(F32, 0.5));
+		B.CreateFCmpOLT(x, y);
+	}
+	B.CreateRetVoid();
+	return F;
+}
+
+/**
+ * @brief classify all the instructions in the function repeatedly
+ * @return elapsed wall time in seconds
+ */
+template <typename MatchFn>
+static double classify(SmallVectorImpl<Instruction*> &insts, unsigned num_conds,
+						MatchFn match, SmallVectorImpl<unsigned> &counts)
+{
+	counts.assign(num_conds, 0);
+	auto start = TimeRecord::getCurrentTime(true);
+	for (unsigned n = 0; n < Iterations; n++) {
+		for (auto I : insts) {
+			for (unsigned c = 0; c < num_conds; c++) {
+				if (match(c, I)) {
+					counts[c]++;
+				}
+			}
+		}
+	}
+	auto elapsed = TimeRecord::getCurrentTime(false);
+	elapsed -= start;
+	return elapsed.getWallTime();
+}
+
+int main(int argc, char **argv)
+{
+	InitLLVM X(argc, argv);
+	cl::ParseCommandLineOptions(argc, argv,
+		"Throughput of the instruction mapping conditions\n");
+
+	ExitOnError Exit(ERR_MSG_PREFIX);
+	LLVMContext Context;
+	Module M("bench", Context);
+	auto F = makeInstructionMix(M, Copies);
+	SmallVector<Instruction*> insts;
+	for (auto &I : F->getEntryBlock()) {
+		insts.push_back(&I);
+	}
+
+	auto specs = getCondSpecs();
+	SmallVector<std::unique_ptr<MapCondition>> flat;
+	SmallVector<std::unique_ptr<LegacyMapCondition>> legacy;
+	for (auto &spec : specs) {
+		auto cond = std::make_unique<MapCondition>(spec.map);
+		Exit(cond->setFlags(spec.flags));
+		if (spec.use_int) {
+			cond->setConst(*spec.use_int, spec.isLeft);
+		} else if (spec.use_double) {
+			cond->setConst(*spec.use_double, spec.isLeft);
+		}
+		if (!spec.pred.empty()) {
+			Exit(cond->setPred(spec.pred));
+		}
+		flat.push_back(std::move(cond));
+		legacy.push_back(std::make_unique<LegacyMapCondition>(spec));
+	}
+
+	SmallVector<unsigned> legacy_counts, flat_counts;
+	double legacy_sec = classify(insts, specs.size(), [&](unsigned c, Instruction *I) {
+		return legacy[c]->match(I);
+	}, legacy_counts);
+	double flat_sec = classify(insts, specs.size(), [&](unsigned c, Instruction *I) {
+		return flat[c]->match(I);
+	}, flat_counts);
+
+	// both must classify the instructions in the same way
+	bool mismatch = false;
+	for (unsigned c = 0; c < specs.size(); c++) {
+		if (legacy_counts[c] != flat_counts[c] || flat_counts[c] == 0) {
+			errs() << formatv(ERR_MSG_PREFIX "{0}: {1} matches (legacy) vs {2} (flat)\n",
+								specs[c].map, legacy_counts[c], flat_counts[c]);
+			mismatch = true;
+		}
+	}
+	if (mismatch) {
+		return 1;
+	}
+
+	double num_tests = (double)Iterations * insts.size() * specs.size();
+	auto report = [&](StringRef name, double sec) {
+		outs() << formatv("{0,-8}: {1:f3} s, {2:f2} ns/test", name, sec,
+							sec * 1e9 / num_tests);
+		if (sec > 0) {
+			outs() << formatv(", {0:f1} Minst/s", Iterations * insts.size() / sec / 1e6);
+		}
+		outs() << "\n";
+	};
+	outs() << formatv("{0} instructions x {1} conditions x {2} iterations\n",
+						insts.size(), specs.size(), Iterations.getValue());
+	report("legacy", legacy_sec);
+	report("flat", flat_sec);
+	if (flat_sec > 0) {
+		outs() << formatv("speedup : {0:f2}x\n", legacy_sec / flat_sec);
+	}
+
+	return 0;
+}
@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+# -*- coding:utf-8 -*-
+
+###
+#   MIT License
+#   
+#   Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+#   
+#   Permission is hereby granted, free of charge, to any person obtaining a copy of
+#   this software and associated documentation files (the "Software"), to deal in
+#   the Software without restriction, including without limitation the rights to
+#   use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#   of the Software, and to permit persons to whom the Software is furnished to do
+#   so, subject to the following conditions:
+#   
+#   The above copyright notice and this permission notice shall be included in all
+#   copies or substantial portions of the Software.
+#   
+#   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#   SOFTWARE.
+#   
+#   File:          /test/kernel_hint/check_unroll.py
+#   Project:       CGRAOmp
+#   Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+#   Created Date:  17-10-2026 06:15:42
+#   Last Modified: 17-10-2026 06:15:42
+###
+
+"""Checks that the unroll hint is applied to a single-level kernel.
+
+The trip count of a work-shared loop is known only after the schedule runtime is removed.
+The unrolled kernel must have twice as many loads and stores as the plain one.
+"""
+
+import sys
+import tempfile
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).absolute().parent.parent))
+from testutils import *
+
+def count_mem_ops(path):
+    ops = [n.get("opcode") for n in dot_nodes(path)]
+    return ops.count("load"), ops.count("store")
+
+def main():
+    args = parse_args()
+
+    testdir = Path(__file__).parent.absolute()
+    with tempfile.TemporaryDirectory() as workdir:
+        compile(args.cgraomp_cc, [testdir / "unroll.c"], workdir,
+                "typycal_time_multiplex.json",
+                ["-O2", "--simplify-dfg-name"])
+        plain = sorted(Path(workdir).glob("kernel_*plain_kernel*.dot"))
+        unrolled = sorted(Path(workdir).glob("kernel_*unrolled_kernel*.dot"))
+        if len(plain) != 1 or len(unrolled) != 1:
+            fail("one DFG per kernel is expected but {0} and {1} are generated".format(
+                    len(plain), len(unrolled)))
+        plain_ops = count_mem_ops(plain[0])
+        unrolled_ops = count_mem_ops(unrolled[0])
+
+    if plain_ops[0] == 0 or plain_ops[1] == 0:
+        fail("memory accesses are not found in the plain kernel: {0}".format(plain_ops))
+    if unrolled_ops != (2 * plain_ops[0], 2 * plain_ops[1]):
+        fail("the unroll hint is not applied: (load, store) = {0} for {1}".format(
+                unrolled_ops, plain_ops))
+
+    print("OK")
+
+if __name__ == "__main__":
+    main()
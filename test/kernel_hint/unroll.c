@@ -0,0 +1,50 @@
+/*
+*    MIT License
+*    
+*    Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+*    
+*    Permission is hereby granted, free of charge, to any person obtaining a copy of
+*    this software and associated documentation files (the "Software"), to deal in
+*    the Software without restriction, including without limitation the rights to
+*    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+*    of the Software, and to permit persons to whom the Software is furnished to do
+*    so, subject to the following conditions:
+*    
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*    
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*    
+*    File:          /test/kernel_hint/unroll.c
+*    Project:       CGRAOmp
+*    Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+*    Created Date:  17-10-2026 06:15:42
+*    Last Modified: 17-10-2026 06:15:42
+*/
+#include <stdint.h>
+#include <cgraomp.h>
+
+#define N 256
+
+void plain_kernel(int *A, int *B){
+	int64_t i;
+	#pragma omp target parallel for map(to:A[:N]) map(from:B[:N]) private(i)
+	for (i = 0; i < N; i++) {
+		B[i] = A[i] * 3 + 1;
+	}
+}
+
+void unrolled_kernel(int *A, int *B){
+	int64_t i;
+	#pragma omp target parallel for map(to:A[:N]) map(from:B[:N]) private(i)
+	for (i = 0; i < N; i++) {
+		CGRAOMP_UNROLL(2);
+		B[i] = A[i] * 3 + 1;
+	}
+}
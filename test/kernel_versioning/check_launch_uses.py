@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+# -*- coding:utf-8 -*-
+
+###
+#   MIT License
+#   
+#   Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+#   
+#   Permission is hereby granted, free of charge, to any person obtaining a copy of
+#   this software and associated documentation files (the "Software"), to deal in
+#   the Software without restriction, including without limitation the rights to
+#   use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#   of the Software, and to permit persons to whom the Software is furnished to do
+#   so, subject to the following conditions:
+#   
+#   The above copyright notice and this permission notice shall be included in all
+#   copies or substantial portions of the Software.
+#   
+#   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#   SOFTWARE.
+#   
+#   File:          /test/kernel_versioning/check_launch_uses.py
+#   Project:       CGRAOmp
+#   Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+#   Created Date:  17-10-2026 06:21:33
+#   Last Modified: 17-10-2026 06:21:33
+###
+
+"""Checks that kernel versioning keeps the host code valid.
+
+The launch result and a value computed before the launch are used after the launch.
+The launch is skipped for small trip counts, so its result must be merged
+with a failure value before those uses. opt verifies the output module.
+"""
+
+import re
+import sys
+import tempfile
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).absolute().parent.parent))
+from testutils import *
+
+def main():
+    args = parse_args()
+
+    testdir = Path(__file__).parent.absolute()
+    with tempfile.TemporaryDirectory() as workdir:
+        out = Path(workdir) / "versioned.ll"
+        run_opt(args.cgraomp_cc, "cgraomp-kernel-versioning",
+                testdir / "launch_uses.ll", out,
+                ["-cm", str(testdir / "tm_min_trip.json")])
+        with open(out) as f:
+            ir = f.read()
+
+    if "%is_small_kernel" not in ir:
+        fail("the trip count check is not inserted")
+    phi = re.search(r"(%[\w.]+) = phi i32 \[ %ret, %[\w.]+ \], \[ 1, %[\w.]+ \]", ir)
+    if phi is None:
+        fail("the launch result is not merged with the skipped launch")
+    if "store i32 {0}, i32* %out".format(phi.group(1)) not in ir:
+        fail("the use of the launch result is not updated")
+    if "store i32 %pre, i32* %arrayidx" not in ir:
+        fail("the value computed before the launch is not used after it")
+
+    print("OK")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,136 @@
+;;;
+;   MIT License
+;   
+;   Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+;   
+;   Permission is hereby granted, free of charge, to any person obtaining a copy of
+;   this software and associated documentation files (the "Software"), to deal in
+;   the Software without restriction, including without limitation the rights to
+;   use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+;   of the Software, and to permit persons to whom the Software is furnished to do
+;   so, subject to the following conditions:
+;   
+;   The above copyright notice and this permission notice shall be included in all
+;   copies or substantial portions of the Software.
+;   
+;   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+;   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+;   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+;   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+;   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+;   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+;   SOFTWARE.
+;   
+;   File:          /test/kernel_versioning/launch_uses.ll
+;   Project:       CGRAOmp
+;   Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+;   Created Date:  17-10-2026 06:21:19
+;   Last Modified: 17-10-2026 06:21:19
+;;;
+
+; Reduced host code of the following target region.
+; The launch result and a value computed before the launch are used after it.
+;
+;   void vec(int *A, int n, int *out) {
+;     #pragma omp target parallel for map(tofrom:A[:1024])
+;     for (int i = 0; i < n; i++) A[i] += 1;
+;   }
+
+%struct.ident_t = type { i32, i32, i32, i32, i8* }
+
+@.str = private unnamed_addr constant [23 x i8] c";unknown;unknown;0;0;;\00", align 1
+@0 = private unnamed_addr global %struct.ident_t { i32 0, i32 2, i32 0, i32 0, i8* getelementptr inbounds ([23 x i8], [23 x i8]* @.str, i32 0, i32 0) }, align 8
+@.__omp_offloading_fd00_1_vec_l7.region_id = weak constant i8 0
+@.offload_sizes = private unnamed_addr constant [2 x i64] [i64 4, i64 4096]
+@.offload_maptypes = private unnamed_addr constant [2 x i64] [i64 800, i64 35]
+
+define dso_local void @vec(i32* %A, i32 %n, i32* %out) {
+entry:
+  %.offload_baseptrs = alloca [2 x i8*], align 8
+  %.offload_ptrs = alloca [2 x i8*], align 8
+  %conv = zext i32 %n to i64
+  %pre = add nsw i32 %n, -1
+  %0 = getelementptr inbounds [2 x i8*], [2 x i8*]* %.offload_baseptrs, i64 0, i64 0
+  %1 = bitcast i8** %0 to i64*
+  store i64 %conv, i64* %1, align 8
+  %2 = getelementptr inbounds [2 x i8*], [2 x i8*]* %.offload_ptrs, i64 0, i64 0
+  %3 = bitcast i8** %2 to i64*
+  store i64 %conv, i64* %3, align 8
+  %4 = getelementptr inbounds [2 x i8*], [2 x i8*]* %.offload_baseptrs, i64 0, i64 1
+  %5 = bitcast i8** %4 to i32**
+  store i32* %A, i32** %5, align 8
+  %6 = getelementptr inbounds [2 x i8*], [2 x i8*]* %.offload_ptrs, i64 0, i64 1
+  %7 = bitcast i8** %6 to i32**
+  store i32* %A, i32** %7, align 8
+  %ret = call i32 @__tgt_target_mapper(%struct.ident_t* @0, i64 -1, i8* @.__omp_offloading_fd00_1_vec_l7.region_id, i32 2, i8** %0, i8** %2, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @.offload_sizes, i64 0, i64 0), i64* getelementptr inbounds ([2 x i64], [2 x i64]* @.offload_maptypes, i64 0, i64 0), i8** null, i8** null)
+  %failed = icmp ne i32 %ret, 0
+  br i1 %failed, label %omp_offload.failed, label %omp_offload.cont
+
+omp_offload.failed:
+  call void @__omp_offloading_fd00_1_vec_l7(i64 %conv, i32* %A)
+  br label %omp_offload.cont
+
+omp_offload.cont:
+  store i32 %ret, i32* %out, align 4
+  %arrayidx = getelementptr inbounds i32, i32* %out, i64 1
+  store i32 %pre, i32* %arrayidx, align 4
+  ret void
+}
+
+define internal void @__omp_offloading_fd00_1_vec_l7(i64 %n, i32* %A) {
+entry:
+  call void (%struct.ident_t*, i32, void (i32*, i32*, ...)*, ...) @__kmpc_fork_call(%struct.ident_t* @0, i32 2, void (i32*, i32*, ...)* bitcast (void (i32*, i32*, i64, i32*)* @.omp_outlined. to void (i32*, i32*, ...)*), i64 %n, i32* %A)
+  ret void
+}
+
+define internal void @.omp_outlined.(i32* noalias %.global_tid., i32* noalias %.bound_tid., i64 %n, i32* %A) {
+entry:
+  %.omp.lb = alloca i32, align 4
+  %.omp.ub = alloca i32, align 4
+  %.omp.stride = alloca i32, align 4
+  %.omp.is_last = alloca i32, align 4
+  %conv = trunc i64 %n to i32
+  %cmp = icmp sgt i32 %conv, 0
+  br i1 %cmp, label %omp.precond.then, label %omp.precond.end
+
+omp.precond.then:
+  %sub = add nsw i32 %conv, -1
+  store i32 0, i32* %.omp.lb, align 4
+  store i32 %sub, i32* %.omp.ub, align 4
+  store i32 1, i32* %.omp.stride, align 4
+  store i32 0, i32* %.omp.is_last, align 4
+  %tid = load i32, i32* %.global_tid., align 4
+  call void @__kmpc_for_static_init_4(%struct.ident_t* @0, i32 %tid, i32 34, i32* %.omp.is_last, i32* %.omp.lb, i32* %.omp.ub, i32* %.omp.stride, i32 1, i32 1)
+  %ub = load i32, i32* %.omp.ub, align 4
+  %cond.gt = icmp sgt i32 %ub, %sub
+  %ub.min = select i1 %cond.gt, i32 %sub, i32 %ub
+  %lb = load i32, i32* %.omp.lb, align 4
+  %empty = icmp sgt i32 %lb, %ub.min
+  br i1 %empty, label %omp.loop.exit, label %omp.inner.for.body
+
+omp.inner.for.body:
+  %iv = phi i32 [ %lb, %omp.precond.then ], [ %iv.next, %omp.inner.for.body ]
+  %idxprom = sext i32 %iv to i64
+  %arrayidx = getelementptr inbounds i32, i32* %A, i64 %idxprom
+  %v = load i32, i32* %arrayidx, align 4
+  %add = add nsw i32 %v, 1
+  store i32 %add, i32* %arrayidx, align 4
+  %iv.next = add nsw i32 %iv, 1
+  %cont = icmp slt i32 %iv, %ub.min
+  br i1 %cont, label %omp.inner.for.body, label %omp.loop.exit
+
+omp.loop.exit:
+  call void @__kmpc_for_static_fini(%struct.ident_t* @0, i32 %tid)
+  br label %omp.precond.end
+
+omp.precond.end:
+  ret void
+}
+
+declare i32 @__tgt_target_mapper(%struct.ident_t*, i64, i8*, i32, i8**, i8**, i64*, i64*, i8**, i8**)
+
+declare void @__kmpc_fork_call(%struct.ident_t*, i32, void (i32*, i32*, ...)*, ...)
+
+declare void @__kmpc_for_static_init_4(%struct.ident_t*, i32, i32, i32*, i32*, i32*, i32*, i32, i32)
+
+declare void @__kmpc_for_static_fini(%struct.ident_t*, i32)
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+# -*- coding:utf-8 -*-
+
+###
+#   MIT License
+#   
+#   Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+#   
+#   Permission is hereby granted, free of charge, to any person obtaining a copy of
+#   this software and associated documentation files (the "Software"), to deal in
+#   the Software without restriction, including without limitation the rights to
+#   use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#   of the Software, and to permit persons to whom the Software is furnished to do
+#   so, subject to the following conditions:
+#   
+#   The above copyright notice and this permission notice shall be included in all
+#   copies or substantial portions of the Software.
+#   
+#   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#   SOFTWARE.
+#   
+#   File:          /test/kernel_weight/check_ranking.py
+#   Project:       CGRAOmp
+#   Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+#   Created Date:  17-10-2026 06:12:58
+#   Last Modified: 17-10-2026 06:12:58
+###
+
+"""Checks the ranking of a profiled kernel and an unprofiled kernel.
+
+The profiled kernel runs 1024 iterations while the unprofiled one has a constant trip count of 256.
+Both have the same loop body, so the profiled kernel must be ranked first
+if the weights are in the same unit.
+"""
+
+import os
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).absolute().parent.parent))
+from testutils import *
+
+def run(cmd, env = None):
+    proc = subprocess.run([str(c) for c in cmd], env=env)
+    if proc.returncode != 0:
+        fail("failed to run " + " ".join([str(c) for c in cmd]))
+
+def main():
+    args = parse_args(lambda p: p.add_argument("--arch", type=str, default="x86_64"))
+
+    testdir = Path(__file__).parent.absolute()
+    profiled = testdir / "profiled.c"
+    unprofiled = testdir / "unprofiled.c"
+    with tempfile.TemporaryDirectory() as workdir:
+        work = Path(workdir)
+        # make a profile only for profiled.c
+        # the target regions are executed by the host fallback
+        run(["clang", "-O2", "-fopenmp", "-fopenmp-targets=" + args.arch,
+                "-fprofile-instr-generate", testdir / "main.c", profiled,
+                "-o", work / "prog"])
+        env = dict(os.environ, LLVM_PROFILE_FILE=str(work / "prog.profraw"),
+                    OMP_TARGET_OFFLOAD="DISABLED")
+        run([work / "prog"], env)
+        run(["llvm-profdata", "merge", "-o", work / "prog.profdata",
+                work / "prog.profraw"])
+
+        compile(args.cgraomp_cc, [profiled, unprofiled], workdir,
+                "typycal_time_multiplex.json",
+                ["-O2", "--simplify-dfg-name", "--profile", str(work / "prog.profdata")])
+
+        kernels = dict()
+        for fname, info in load_extra_info(workdir).items():
+            for name in ["profiled_kernel", "unprofiled_kernel"]:
+                if "_{0}_".format(name) in fname:
+                    kernels[name] = info["__GRAPH"]
+
+    for name in ["profiled_kernel", "unprofiled_kernel"]:
+        if name not in kernels:
+            fail("no DFG is generated for " + name)
+    if not kernels["profiled_kernel"]["profiled"]:
+        fail("the profile is not used for profiled_kernel")
+    if kernels["unprofiled_kernel"]["profiled"]:
+        fail("unprofiled_kernel is regarded as profiled")
+
+    weights = {name: k["weight"] for name, k in kernels.items()}
+    ranking = sorted(weights.keys(), key=lambda name: -weights[name])
+    if ranking[0] != "profiled_kernel":
+        fail("unexpected ranking {0}".format(weights))
+
+    print("weights: {0}".format(weights))
+
+if __name__ == "__main__":
+    main()
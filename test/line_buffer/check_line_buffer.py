@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+# -*- coding:utf-8 -*-
+
+###
+#   MIT License
+#   
+#   Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+#   
+#   Permission is hereby granted, free of charge, to any person obtaining a copy of
+#   this software and associated documentation files (the "Software"), to deal in
+#   the Software without restriction, including without limitation the rights to
+#   use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#   of the Software, and to permit persons to whom the Software is furnished to do
+#   so, subject to the following conditions:
+#   
+#   The above copyright notice and this permission notice shall be included in all
+#   copies or substantial portions of the Software.
+#   
+#   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#   SOFTWARE.
+#   
+#   File:          /test/line_buffer/check_line_buffer.py
+#   Project:       CGRAOmp
+#   Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+#   Created Date:  17-10-2026 05:41:13
+#   Last Modified: 17-10-2026 05:41:13
+###
+
+"""Checks the line buffer generated for a 3x3 stencil.
+
+The AG configuration and the line buffer parameters exported by the line-buffer DFG pass
+and the shift register chain in the emitted DFG are compared with the values
+derived from the array shape.
+"""
+
+import sys
+import tempfile
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).absolute().parent.parent))
+from testutils import *
+
+HEIGHT = 16
+WIDTH = 32
+# int array
+ELEM_BYTES = 4
+
+def find_line_buffer(workdir):
+    for fname, info in load_extra_info(workdir).items():
+        for name, entry in info.items():
+            if isinstance(entry, dict) and "LineBuffer" in entry:
+                return fname, entry
+    return None, None
+
+def main():
+    args = parse_args()
+
+    src = Path(__file__).parent.absolute() / "stencil3x3.c"
+    with tempfile.TemporaryDirectory() as workdir:
+        compile(args.cgraomp_cc, [src], workdir, "decoupled_affine_AG.json",
+                ["-O2", "--dfg-pass-pipeline=line-buffer"])
+
+        fname, entry = find_line_buffer(workdir)
+        if entry is None:
+            fail("no line buffer is generated")
+        dot = Path(workdir) / fname.replace("_extra.json", ".dot")
+        nodes = dot_nodes(dot)
+
+    lb = entry["LineBuffer"]
+    config = entry["AGConfig"]["offset"]
+
+    # delay of the earliest tap (-1, -1) from the leader (+1, +1)
+    depth = 2 * WIDTH + 2
+    if lb["depth"] != depth:
+        fail("unexpected depth {0}".format(lb["depth"]))
+    # x runs over [1, WIDTH - 1) and the stream is extended to the full row
+    if lb["row_extension"] != 2:
+        fail("unexpected row extension {0}".format(lb["row_extension"]))
+    if lb["warmup"] != depth - lb["row_extension"]:
+        fail("unexpected warm-up {0}".format(lb["warmup"]))
+
+    # the stream is flattened and starts earlier by the warm-up and the row extension
+    if len(config) != 1:
+        fail("the stream is not flattened: {0}".format(config))
+    stream = config[0]
+    if stream["step"] != ELEM_BYTES:
+        fail("unexpected step {0}".format(stream["step"]))
+    if stream["count"] != (HEIGHT - 2) * WIDTH + lb["warmup"]:
+        fail("unexpected count {0}".format(stream["count"]))
+    # the leader reads (2, 2) at the first output
+    first = stream["start"] + (lb["warmup"] + lb["row_extension"]) * stream["step"]
+    if first != (2 + 2 * WIDTH) * ELEM_BYTES:
+        fail("the leader reads offset {0} at the first output".format(first))
+
+    # the other 8 taps are connected via a chain of shift registers
+    delays = sorted([int(n["depth"]) for n in nodes \
+                        if n.get("opcode") == "shiftreg"])
+    if delays != sorted([1, 1, WIDTH - 2, 1, 1, WIDTH - 2, 1, 1]):
+        fail("unexpected shift register chain {0}".format(delays))
+
+    print("line buffer: depth {0}, warm-up {1}".format(lb["depth"], lb["warmup"]))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+# -*- coding:utf-8 -*-
+
+###
+#   MIT License
+#   
+#   Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+#   
+#   Permission is hereby granted, free of charge, to any person obtaining a copy of
+#   this software and associated documentation files (the "Software"), to deal in
+#   the Software without restriction, including without limitation the rights to
+#   use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#   of the Software, and to permit persons to whom the Software is furnished to do
+#   so, subject to the following conditions:
+#   
+#   The above copyright notice and this permission notice shall be included in all
+#   copies or substantial portions of the Software.
+#   
+#   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#   SOFTWARE.
+#   
+#   File:          /test/loop_counter/check_unknown_bound.py
+#   Project:       CGRAOmp
+#   Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+#   Created Date:  17-10-2026 06:11:49
+#   Last Modified: 17-10-2026 06:11:49
+###
+
+"""Checks that a loop with an unknown bound is not mapped to a loop counter.
+
+A counter without the bound or the predicate cannot terminate by itself.
+The induction variable of such a loop must be lowered to an add node with a self loop.
+"""
+
+import sys
+import tempfile
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).absolute().parent.parent))
+from testutils import *
+
+def main():
+    args = parse_args()
+
+    testdir = Path(__file__).parent.absolute()
+    with tempfile.TemporaryDirectory() as workdir:
+        compile(args.cgraomp_cc, [testdir / "unknown_bound.c"], workdir,
+                testdir / "tm_loop_counter.json", ["-O2"])
+        dots = sorted(Path(workdir).glob("kernel_*.dot"))
+        if len(dots) != 1:
+            fail("one DFG is expected but {0} are generated".format(len(dots)))
+        nodes, edges = load_dot(dots[0])
+
+    # every counter must be able to terminate
+    for nid, attrs in nodes.items():
+        if attrs.get("opcode") != "counter":
+            continue
+        has_bound = "bound" in attrs or \
+            any(dst == nid and e.get("operand") == "1" for _, dst, e in edges)
+        if not has_bound or "cmp" not in attrs:
+            fail("counter {0} has no termination condition: {1}".format(nid, attrs))
+
+    # the induction variable with the unknown bound
+    self_loops = [src for src, dst, e in edges \
+                    if src == dst and e.get("dir") == "back" and \
+                        nodes.get(src, {}).get("opcode") == "add"]
+    if len(self_loops) == 0:
+        fail("the induction variable is not lowered to an add node with a self loop")
+
+    print("OK")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+# -*- coding:utf-8 -*-
+
+###
+#   MIT License
+#   
+#   Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+#   
+#   Permission is hereby granted, free of charge, to any person obtaining a copy of
+#   this software and associated documentation files (the "Software"), to deal in
+#   the Software without restriction, including without limitation the rights to
+#   use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#   of the Software, and to permit persons to whom the Software is furnished to do
+#   so, subject to the following conditions:
+#   
+#   The above copyright notice and this permission notice shall be included in all
+#   copies or substantial portions of the Software.
+#   
+#   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#   SOFTWARE.
+#   
+#   File:          /test/testutils.py
+#   Project:       CGRAOmp
+#   Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+#   Created Date:  17-10-2026 06:09:46
+#   Last Modified: 17-10-2026 06:09:46
+###
+
+"""Common routines for the tests driving cgraomp-cc in the build tree."""
+
+from argparse import ArgumentParser
+import json
+import re
+import subprocess
+import sys
+from pathlib import Path
+
+def fail(msg):
+    print("FAIL:", msg)
+    sys.exit(1)
+
+def parse_args(extra = None):
+    """parse the common arguments (and test specific ones added by extra)"""
+    argparser = ArgumentParser()
+    argparser.add_argument("--cgraomp-cc", type=str, required=True)
+    if extra is not None:
+        extra(argparser)
+    args = argparser.parse_args()
+    if not Path(args.cgraomp_cc).exists():
+        fail("cgraomp-cc is not found: " + args.cgraomp_cc)
+    return args
+
+def compile(driver, sources, workdir, config, options = []):
+    """compile the sources and save the DFGs in workdir with the prefix "kernel" """
+    cmd = [sys.executable, driver] + [str(s) for s in sources]
+    cmd += ["-cc", str(config), "--no-rich-console",
+            "--dfg-file-prefix=" + str(Path(workdir) / "kernel"),
+            "-o", str(Path(workdir) / "a.out")]
+    cmd += options
+    proc = subprocess.run(cmd, cwd=workdir)
+    if proc.returncode != 0:
+        fail("failed to compile " + " ".join([str(s) for s in sources]))
+
+PLUGINS = ["libCGRAOmpAnnotationPass.so", "libCGRAModel.so", "libCGRAOmpPass.so",
+            "libCGRAOmpVerifyPass.so", "libCGRAOmpDFGPass.so"]
+
+def run_opt(driver, passes, infile, outfile, options = []):
+    """run opt with the staged plugins in the same way as cgraomp-cc"""
+    libdir = Path(driver).absolute().parent.parent / "lib"
+    cmd = ["opt", "-S", "-load", str(libdir / "libCGRAOmpComponents.so"),
+            "--enable-new-pm"]
+    for plugin in PLUGINS:
+        cmd += ["-load-pass-plugin", str(libdir / plugin)]
+    cmd += ["-passes=" + passes] + options
+    cmd += [str(infile), "-o", str(outfile)]
+    proc = subprocess.run(cmd)
+    if proc.returncode != 0:
+        fail("opt failed for {0} on {1}".format(passes, infile))
+
+def load_extra_info(workdir):
+    """contents of the extra info files keyed by the file name"""
+    info = dict()
+    for extra in sorted(Path(workdir).glob("*_extra.json")):
+        with open(extra) as f:
+            info[extra.name] = json.load(f)
+    return info
+
+def load_manifest(path):
+    with open(path) as f:
+        return json.load(f)
+
+NODE_ATTR = re.compile(r"^\s*(\w+)\s*\[(.*)\];?\s*$")
+EDGE_ATTR = re.compile(r"^\s*(\w+)(?::\w+)?\s*->\s*(\w+)(?::\w+)?\s*\[(.*)\];?\s*$")
+
+def parse_attrs(attr_str):
+    attrs = dict()
+    for item in re.findall(r'(\w+)=("[^"]*"|[^,\s]+)', attr_str):
+        attrs[item[0]] = item[1].strip('"')
+    return attrs
+
+def load_dot(path):
+    """nodes (attributes keyed by the node ID) and edges (src, dst, attributes) in a DOT file"""
+    nodes = dict()
+    edges = []
+    with open(path) as f:
+        for line in f:
+            m = EDGE_ATTR.match(line)
+            if m is not None:
+                edges.append((m.group(1), m.group(2), parse_attrs(m.group(3))))
+                continue
+            m = NODE_ATTR.match(line)
+            if m is not None:
+                nodes[m.group(1)] = parse_attrs(m.group(2))
+    return nodes, edges
+
+def dot_nodes(path):
+    """attributes of the nodes in a DOT file as a list of dict"""
+    return list(load_dot(path)[0].values())
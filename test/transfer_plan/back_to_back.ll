@@ -0,0 +1,125 @@
+;;;
+;   MIT License
+;   
+;   Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+;   
+;   Permission is hereby granted, free of charge, to any person obtaining a copy of
+;   this software and associated documentation files (the "Software"), to deal in
+;   the Software without restriction, including without limitation the rights to
+;   use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+;   of the Software, and to permit persons to whom the Software is furnished to do
+;   so, subject to the following conditions:
+;   
+;   The above copyright notice and this permission notice shall be included in all
+;   copies or substantial portions of the Software.
+;   
+;   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+;   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+;   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+;   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+;   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+;   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+;   SOFTWARE.
+;   
+;   File:          /test/transfer_plan/back_to_back.ll
+;   Project:       CGRAOmp
+;   Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+;   Created Date:  17-10-2026 06:25:44
+;   Last Modified: 17-10-2026 06:25:44
+;;;
+; Reduced host code of two kernels launched back to back.
+; The second kernel copies in A that the first one copied back.
+; Only in @shared, the kernels are in a target data region (mapping B)
+; which can keep A on the device between them.
+;
+;   void split(int *A) {
+;     #pragma omp target map(tofrom:A[:1024])
+;     ...
+;     #pragma omp target map(to:A[:1024])
+;     ...
+;   }
+;
+;   void shared(int *A, int *B) {
+;     #pragma omp target data map(tofrom:B[:1024])
+;     {
+;       #pragma omp target map(tofrom:A[:1024])
+;       ...
+;       #pragma omp target map(to:A[:1024])
+;       ...
+;     }
+;   }
+
+%struct.ident_t = type { i32, i32, i32, i32, i8* }
+
+@.str = private unnamed_addr constant [23 x i8] c";unknown;unknown;0;0;;\00", align 1
+@0 = private unnamed_addr global %struct.ident_t { i32 0, i32 2, i32 0, i32 0, i8* getelementptr inbounds ([23 x i8], [23 x i8]* @.str, i32 0, i32 0) }, align 8
+@.__omp_offloading_fd00_1_split_l3.region_id = weak constant i8 0
+@.__omp_offloading_fd00_1_split_l5.region_id = weak constant i8 0
+@.__omp_offloading_fd00_1_shared_l12.region_id = weak constant i8 0
+@.__omp_offloading_fd00_1_shared_l14.region_id = weak constant i8 0
+@.offload_sizes = private unnamed_addr constant [1 x i64] [i64 4096]
+@.offload_maptypes = private unnamed_addr constant [1 x i64] [i64 35]
+@.offload_maptypes.1 = private unnamed_addr constant [1 x i64] [i64 33]
+@.offload_maptypes.2 = private unnamed_addr constant [1 x i64] [i64 3]
+
+define dso_local void @split(i32* %A) {
+entry:
+  %.offload_baseptrs = alloca [1 x i8*], align 8
+  %.offload_ptrs = alloca [1 x i8*], align 8
+  %.offload_baseptrs1 = alloca [1 x i8*], align 8
+  %.offload_ptrs2 = alloca [1 x i8*], align 8
+  %0 = getelementptr inbounds [1 x i8*], [1 x i8*]* %.offload_baseptrs, i64 0, i64 0
+  %1 = bitcast i8** %0 to i32**
+  store i32* %A, i32** %1, align 8
+  %2 = getelementptr inbounds [1 x i8*], [1 x i8*]* %.offload_ptrs, i64 0, i64 0
+  %3 = bitcast i8** %2 to i32**
+  store i32* %A, i32** %3, align 8
+  %4 = call i32 @__tgt_target_mapper(%struct.ident_t* @0, i64 -1, i8* @.__omp_offloading_fd00_1_split_l3.region_id, i32 1, i8** %0, i8** %2, i64* getelementptr inbounds ([1 x i64], [1 x i64]* @.offload_sizes, i64 0, i64 0), i64* getelementptr inbounds ([1 x i64], [1 x i64]* @.offload_maptypes, i64 0, i64 0), i8** null, i8** null)
+  %5 = getelementptr inbounds [1 x i8*], [1 x i8*]* %.offload_baseptrs1, i64 0, i64 0
+  %6 = bitcast i8** %5 to i32**
+  store i32* %A, i32** %6, align 8
+  %7 = getelementptr inbounds [1 x i8*], [1 x i8*]* %.offload_ptrs2, i64 0, i64 0
+  %8 = bitcast i8** %7 to i32**
+  store i32* %A, i32** %8, align 8
+  %9 = call i32 @__tgt_target_mapper(%struct.ident_t* @0, i64 -1, i8* @.__omp_offloading_fd00_1_split_l5.region_id, i32 1, i8** %5, i8** %7, i64* getelementptr inbounds ([1 x i64], [1 x i64]* @.offload_sizes, i64 0, i64 0), i64* getelementptr inbounds ([1 x i64], [1 x i64]* @.offload_maptypes.1, i64 0, i64 0), i8** null, i8** null)
+  ret void
+}
+
+define dso_local void @shared(i32* %A, i32* %B) {
+entry:
+  %.offload_baseptrs = alloca [1 x i8*], align 8
+  %.offload_ptrs = alloca [1 x i8*], align 8
+  %.offload_baseptrs1 = alloca [1 x i8*], align 8
+  %.offload_ptrs2 = alloca [1 x i8*], align 8
+  %.offload_baseptrs3 = alloca [1 x i8*], align 8
+  %.offload_ptrs4 = alloca [1 x i8*], align 8
+  %0 = getelementptr inbounds [1 x i8*], [1 x i8*]* %.offload_baseptrs, i64 0, i64 0
+  %1 = bitcast i8** %0 to i32**
+  store i32* %B, i32** %1, align 8
+  %2 = getelementptr inbounds [1 x i8*], [1 x i8*]* %.offload_ptrs, i64 0, i64 0
+  %3 = bitcast i8** %2 to i32**
+  store i32* %B, i32** %3, align 8
+  call void @__tgt_target_data_begin_mapper(%struct.ident_t* @0, i64 -1, i32 1, i8** %0, i8** %2, i64* getelementptr inbounds ([1 x i64], [1 x i64]* @.offload_sizes, i64 0, i64 0), i64* getelementptr inbounds ([1 x i64], [1 x i64]* @.offload_maptypes.2, i64 0, i64 0), i8** null, i8** null)
+  %4 = getelementptr inbounds [1 x i8*], [1 x i8*]* %.offload_baseptrs1, i64 0, i64 0
+  %5 = bitcast i8** %4 to i32**
+  store i32* %A, i32** %5, align 8
+  %6 = getelementptr inbounds [1 x i8*], [1 x i8*]* %.offload_ptrs2, i64 0, i64 0
+  %7 = bitcast i8** %6 to i32**
+  store i32* %A, i32** %7, align 8
+  %8 = call i32 @__tgt_target_mapper(%struct.ident_t* @0, i64 -1, i8* @.__omp_offloading_fd00_1_shared_l12.region_id, i32 1, i8** %4, i8** %6, i64* getelementptr inbounds ([1 x i64], [1 x i64]* @.offload_sizes, i64 0, i64 0), i64* getelementptr inbounds ([1 x i64], [1 x i64]* @.offload_maptypes, i64 0, i64 0), i8** null, i8** null)
+  %9 = getelementptr inbounds [1 x i8*], [1 x i8*]* %.offload_baseptrs3, i64 0, i64 0
+  %10 = bitcast i8** %9 to i32**
+  store i32* %A, i32** %10, align 8
+  %11 = getelementptr inbounds [1 x i8*], [1 x i8*]* %.offload_ptrs4, i64 0, i64 0
+  %12 = bitcast i8** %11 to i32**
+  store i32* %A, i32** %12, align 8
+  %13 = call i32 @__tgt_target_mapper(%struct.ident_t* @0, i64 -1, i8* @.__omp_offloading_fd00_1_shared_l14.region_id, i32 1, i8** %9, i8** %11, i64* getelementptr inbounds ([1 x i64], [1 x i64]* @.offload_sizes, i64 0, i64 0), i64* getelementptr inbounds ([1 x i64], [1 x i64]* @.offload_maptypes.1, i64 0, i64 0), i8** null, i8** null)
+  call void @__tgt_target_data_end_mapper(%struct.ident_t* @0, i64 -1, i32 1, i8** %0, i8** %2, i64* getelementptr inbounds ([1 x i64], [1 x i64]* @.offload_sizes, i64 0, i64 0), i64* getelementptr inbounds ([1 x i64], [1 x i64]* @.offload_maptypes.2, i64 0, i64 0), i8** null, i8** null)
+  ret void
+}
+
+declare i32 @__tgt_target_mapper(%struct.ident_t*, i64, i8*, i32, i8**, i8**, i64*, i64*, i8**, i8**)
+
+declare void @__tgt_target_data_begin_mapper(%struct.ident_t*, i64, i32, i8**, i8**, i64*, i64*, i8**, i8**)
+
+declare void @__tgt_target_data_end_mapper(%struct.ident_t*, i64, i32, i8**, i8**, i64*, i64*, i8**, i8**)
@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+# -*- coding:utf-8 -*-
+
+###
+#   MIT License
+#   
+#   Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+#   
+#   Permission is hereby granted, free of charge, to any person obtaining a copy of
+#   this software and associated documentation files (the "Software"), to deal in
+#   the Software without restriction, including without limitation the rights to
+#   use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#   of the Software, and to permit persons to whom the Software is furnished to do
+#   so, subject to the following conditions:
+#   
+#   The above copyright notice and this permission notice shall be included in all
+#   copies or substantial portions of the Software.
+#   
+#   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#   SOFTWARE.
+#   
+#   File:          /test/transfer_plan/check_redundant.py
+#   Project:       CGRAOmp
+#   Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+#   Created Date:  17-10-2026 06:25:50
+#   Last Modified: 17-10-2026 06:25:50
+###
+
+"""Checks redundant copy-ins in the data transfer plan.
+
+Two kernels copy A back and in again without any host access between them.
+The copy-in is redundant only if the kernels share an enclosing target data region.
+"""
+
+import json
+import sys
+import tempfile
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).absolute().parent.parent))
+from testutils import *
+
+def main():
+    args = parse_args()
+
+    testdir = Path(__file__).parent.absolute()
+    with tempfile.TemporaryDirectory() as workdir:
+        plan_file = Path(workdir) / "transfer_plan.json"
+        run_opt(args.cgraomp_cc, "cgraomp-transfer-plan",
+                testdir / "back_to_back.ll", Path(workdir) / "out.ll",
+                ["-transfer-plan-file=" + str(plan_file)])
+        with open(plan_file) as f:
+            plan = json.load(f)
+
+    redundant = dict()
+    for event in plan["events"]:
+        if event["kind"] != "kernel":
+            continue
+        for entry in event["transfers"]:
+            if entry["symbol"] == "A" and entry["to_device"]:
+                redundant.setdefault(event["function"], []).append(entry["redundant"])
+
+    if redundant.get("split") != [False, False]:
+        fail("copy-ins outside target data regions are marked as redundant: {0}".format(redundant.get("split")))
+    if redundant.get("shared") != [False, True]:
+        fail("the copy-in in the same target data region is not marked as redundant: {0}".format(redundant.get("shared")))
+
+    print("OK")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+# -*- coding:utf-8 -*-
+
+###
+#   MIT License
+#   
+#   Copyright (c) 2022 Amano laboratory, Keio University & Processor Research Team, RIKEN Center for Computational Science
+#   
+#   Permission is hereby granted, free of charge, to any person obtaining a copy of
+#   this software and associated documentation files (the "Software"), to deal in
+#   the Software without restriction, including without limitation the rights to
+#   use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#   of the Software, and to permit persons to whom the Software is furnished to do
+#   so, subject to the following conditions:
+#   
+#   The above copyright notice and this permission notice shall be included in all
+#   copies or substantial portions of the Software.
+#   
+#   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#   SOFTWARE.
+#   
+#   File:          /test/wide_access/check_ag_config.py
+#   Project:       CGRAOmp
+#   Author:        Takuya Kojima in The University of Tokyo (tkojima@hal.ipc.i.u-tokyo.ac.jp)
+#   Created Date:  17-10-2026 06:23:41
+#   Last Modified: 17-10-2026 06:23:41
+###
+
+"""Checks the AG config of a wide load for a decoupled CGRA.
+
+A[2i] and A[2i+1] are merged into a wide load of two lanes.
+The AG must issue it at the address of A[2i] in every iteration with the lane count and width.
+"""
+
+import sys
+import tempfile
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).absolute().parent.parent))
+from testutils import *
+
+N = 256
+ELEM_BYTES = 4
+
+def main():
+    args = parse_args()
+
+    testdir = Path(__file__).parent.absolute()
+    with tempfile.TemporaryDirectory() as workdir:
+        compile(args.cgraomp_cc, [testdir / "pair_sum.c"], workdir,
+                testdir / "decoupled_wide.json",
+                ["-O2", "--dfg-pass-pipeline=wide-mem-access"])
+        info = load_extra_info(workdir)
+
+    configs = [entry["AGConfig"] for extra in info.values() \
+                for entry in extra.values() \
+                if isinstance(entry, dict) and "lanes" in entry.get("AGConfig", {})]
+    if len(configs) != 1:
+        fail("one wide load is expected but {0} are found".format(len(configs)))
+    config = configs[0]
+
+    if config["lanes"] != 2 or config["width"] != ELEM_BYTES * 8:
+        fail("unexpected lanes {0} and width {1}".format(config["lanes"], config["width"]))
+    offset = config["offset"]
+    if len(offset) != 1:
+        fail("unexpected dimensions {0}".format(offset))
+    if offset[0]["step"] != 2 * ELEM_BYTES or offset[0]["count"] != N:
+        fail("the stream does not follow the wide load: {0}".format(offset[0]))
+
+    print("OK")
+
+if __name__ == "__main__":
+    main()